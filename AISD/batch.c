@@ -0,0 +1,188 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "batch.h"
+#include "priority_queue.h"
+#include "threadpool.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+typedef struct {
+    const char* input;
+    char* output;
+    uint64_t input_size;
+    uint64_t output_size;
+    uint64_t original_size;       // Rozmiar oryginału (do MB/s niezależnie od trybu)
+    HuffmanStats stats;
+    int exists;                   // Plik wynikowy istniał, a nadpisywanie nie jest dozwolone
+    int ok;
+} BatchJob;
+
+typedef struct {
+    PriorityQueue* queue;         // Zadania czekające na wątek, największe na szczycie
+    pthread_mutex_t lock;
+    BatchMode mode;
+    HuffmanOptions options;
+} BatchContext;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t file_size(const char* name) {
+    struct stat st;
+    return stat(name, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+static int file_exists(const char* name) {
+    struct stat st;
+    return stat(name, &st) == 0;
+}
+
+static char* output_name(const char* input, BatchMode mode) {
+    size_t length = strlen(input);
+    size_t extension = strlen(BATCH_EXTENSION);
+    char* name = (char*)malloc(length + extension + 5);
+    if (!name) return NULL;
+
+    strcpy(name, input);
+    if (mode == BATCH_COMPRESS) {
+        strcat(name, BATCH_EXTENSION);
+    } else if (length > extension && strcmp(input + length - extension, BATCH_EXTENSION) == 0) {
+        name[length - extension] = '\0';
+    } else {
+        strcat(name, ".out");
+    }
+    return name;
+}
+
+static const char* const mode_names[] = {"Kompresja", "Dekompresja", "Weryfikacja"};
+
+// Priorytet kolejki (mniejszy = wcześniej): ujemny rozmiar w KB
+static int job_priority(uint64_t size) {
+    uint64_t kb = size >> 10;
+    return kb >= (uint64_t)INT_MAX ? -INT_MAX : -(int)kb;
+}
+
+// Każde wywołanie zdejmuje z kolejki największy pozostały plik
+static void batch_task(void* context, size_t index) {
+    (void)index;
+    BatchContext* batch = (BatchContext*)context;
+
+    pthread_mutex_lock(&batch->lock);
+    BatchJob* job = (BatchJob*)pq_remove(batch->queue);
+    pthread_mutex_unlock(&batch->lock);
+    if (!job) return;
+
+    // Statystyki zbierane zawsze: rozmiar oryginału przy dekompresji i weryfikacji pochodzi z nich
+    HuffmanOptions options = batch->options;
+    options.stats = &job->stats;
+    if (batch->mode == BATCH_VERIFY) {
+        job->ok = huffman_verify_with_options(job->input, &options);
+        job->original_size = job->ok ? job->stats.bytes_out : 0;
+        return;
+    }
+    if (job->exists) return;
+    job->ok = job->output != NULL &&
+              (batch->mode == BATCH_DECOMPRESS ? huffman_decompress_with_options(job->input, job->output, &options)
+                                               : huffman_compress_with_options(job->input, job->output, &options));
+    job->output_size = job->ok ? file_size(job->output) : 0;
+    job->original_size = !job->ok ? 0 : batch->mode == BATCH_COMPRESS ? job->input_size : job->output_size;
+
+    // Niepełny wynik nie zostaje na dysku
+    if (!job->ok && job->output) remove(job->output);
+}
+
+size_t batch_run(const char* const files[], size_t count, BatchMode mode, int jobs, int force,
+                 const HuffmanOptions* options) {
+    if (count == 0) return 0;
+
+    BatchJob* batch_jobs = (BatchJob*)calloc(count, sizeof(BatchJob));
+    void** data = (void**)malloc(count * sizeof(void*));
+    int* priorities = (int*)malloc(count * sizeof(int));
+    if (!batch_jobs || !data || !priorities) {
+        printf("Błąd: Brak pamięci!\n");
+        free(batch_jobs);
+        free(data);
+        free(priorities);
+        return count;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        batch_jobs[i].input = files[i];
+        batch_jobs[i].output = mode == BATCH_VERIFY ? NULL : output_name(files[i], mode);
+        batch_jobs[i].input_size = file_size(files[i]);
+        batch_jobs[i].exists = !force && batch_jobs[i].output && file_exists(batch_jobs[i].output);
+        data[i] = &batch_jobs[i];
+        priorities[i] = job_priority(batch_jobs[i].input_size);
+    }
+
+    BatchContext context;
+    // Kolejka budowana jednym pq_add_batch; liczniki włączane przed wstawieniem, aby je objąć
+    context.queue = pq_create(count);
+    if (context.queue && options->stats) pq_enable_stats(context.queue, 1);
+    if (context.queue && !pq_add_batch(context.queue, data, priorities, count, NULL)) {
+        pq_destroy(context.queue);
+        context.queue = NULL;
+    }
+    context.mode = mode;
+    context.options = *options;
+    context.options.threads = 1;    // Równoległość między plikami, nie wewnątrz pliku
+    context.options.quiet = 1;
+    pthread_mutex_init(&context.lock, NULL);
+
+    ThreadPool* pool = context.queue ? threadpool_create(jobs) : NULL;
+    int threads = pool ? threadpool_size(pool) : 0;
+    double start = now_seconds();
+    if (pool) threadpool_for(pool, count, batch_task, &context);
+    double elapsed = now_seconds() - start;
+
+    size_t failed = 0;
+    uint64_t total_in = 0, total_out = 0, total_original = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (batch_jobs[i].exists) {
+            printf("Błąd: Plik %s już istnieje (-f nadpisuje)!\n", batch_jobs[i].output);
+        } else if (!batch_jobs[i].ok) {
+            printf("Błąd: Nie udało się przetworzyć pliku %s!\n", batch_jobs[i].input);
+        }
+        if (!batch_jobs[i].ok) failed++;
+        total_in += batch_jobs[i].input_size;
+        total_out += batch_jobs[i].output_size;
+        total_original += batch_jobs[i].original_size;
+        free(batch_jobs[i].output);
+    }
+
+    double mb = (double)total_original / 1e6;
+    printf("%s: przetworzono %zu z %zu plików, %llu B", mode_names[mode], count - failed, count,
+           (unsigned long long)total_in);
+    if (mode != BATCH_VERIFY) printf(" -> %llu B", (unsigned long long)total_out);
+    printf(", %.3f s, %.2f MB/s, wątki: %d\n", elapsed, elapsed > 0 ? mb / elapsed : 0.0, threads);
+
+    // Statystyki zakończonych plików; czasy faz są sumą po wątkach, razem = czas całego wsadu
+    if (options->stats && context.queue) {
+        huffman_stats_reset(options->stats);
+        for (size_t i = 0; i < count; i++) {
+            if (batch_jobs[i].ok) huffman_stats_add(options->stats, &batch_jobs[i].stats);
+        }
+        options->stats->total_seconds = elapsed;
+        huffman_print_stats(options->stats);
+
+        PQStats queue_stats;
+        pq_get_stats(context.queue, &queue_stats);
+        pq_print_stats(&queue_stats);
+    }
+
+    threadpool_destroy(pool);
+    pthread_mutex_destroy(&context.lock);
+    pq_destroy(context.queue);
+    free(batch_jobs);
+    free(data);
+    free(priorities);
+    return threads > 0 ? failed : count;
+}
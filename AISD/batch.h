@@ -0,0 +1,23 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include "huffman.h"
+
+#define BATCH_EXTENSION ".huf"
+
+typedef enum {
+    BATCH_COMPRESS,
+    BATCH_DECOMPRESS,
+    BATCH_VERIFY          // Dekodowanie i sprawdzenie sum kontrolnych bez zapisu
+} BatchMode;
+
+// Przetwarza wiele plików naraz na `jobs` wątkach (0 = wszystkie rdzenie).
+// Pliki przydzielane są od największego, więc najdłuższe zadania startują najwcześniej.
+// Wynik kompresji: <plik>.huf; dekompresja usuwa .huf (albo dopisuje .out). Istniejący plik wynikowy
+// jest nadpisywany tylko przy `force`, w przeciwnym razie plik wejściowy liczy się jako nieudany.
+// Zwraca liczbę plików, których nie udało się przetworzyć.
+size_t batch_run(const char* const files[], size_t count, BatchMode mode, int jobs, int force,
+                 const HuffmanOptions* options);
+
+#endif // BATCH_H
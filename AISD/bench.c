@@ -0,0 +1,409 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "huffman.h"
+
+#define BENCH_INPUT "bench_input.tmp"
+#define BENCH_COMPRESSED "bench_compressed.tmp"
+#define BENCH_OUTPUT "bench_output.tmp"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static HuffmanOptions bench_options;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void generate_text(unsigned char* buf, size_t size) {
+    static const char* words[] = {
+        "the", "of", "and", "to", "in", "is", "that", "for", "it", "as",
+        "was", "with", "be", "by", "on", "not", "he", "this", "are", "or",
+        "huffman", "code", "tree", "priority", "queue", "compression", "data"
+    };
+    size_t n = sizeof(words) / sizeof(words[0]);
+    size_t pos = 0;
+    while (pos < size) {
+        const char* w = words[rng_next() % n];
+        for (size_t i = 0; w[i] && pos < size; i++) buf[pos++] = (unsigned char)w[i];
+        if (pos < size) buf[pos++] = (rng_next() % 12 == 0) ? '\n' : ' ';
+    }
+}
+
+static void generate_skewed(unsigned char* buf, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        uint64_t r = rng_next();
+        int symbol = 0;
+        while ((r & 1) && symbol < 255) {
+            symbol++;
+            r >>= 1;
+        }
+        buf[i] = (unsigned char)symbol;
+    }
+}
+
+static void generate_random(unsigned char* buf, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (unsigned char)rng_next();
+    }
+}
+
+static int files_equal(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    int equal = fa && fb;
+    while (equal) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) equal = 0;
+        if (ca == EOF || cb == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return equal;
+}
+
+static long file_size(const char* name) {
+    FILE* f = fopen(name, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static void run_case(const char* name, void (*generate)(unsigned char*, size_t), size_t size) {
+    unsigned char* buf = (unsigned char*)malloc(size);
+    if (!buf) return;
+    generate(buf, size);
+
+    FILE* f = fopen(BENCH_INPUT, "wb");
+    if (!f) {
+        free(buf);
+        return;
+    }
+    fwrite(buf, 1, size, f);
+    fclose(f);
+
+    double t0 = now_seconds();
+    int ok = huffman_compress_with_options(BENCH_INPUT, BENCH_COMPRESSED, &bench_options);
+    double t1 = now_seconds();
+    ok = ok && huffman_decompress_with_options(BENCH_COMPRESSED, BENCH_OUTPUT, &bench_options);
+    double t2 = now_seconds();
+    ok = ok && files_equal(BENCH_INPUT, BENCH_OUTPUT);
+
+    // Odczyt ostatniego kilobajta przez indeks bloków
+    unsigned char tail[1024];
+    size_t tail_size = size < sizeof(tail) ? size : sizeof(tail);
+    double t3 = now_seconds();
+    int64_t got = huffman_decompress_range(BENCH_COMPRESSED, size - tail_size, tail_size, tail);
+    double t4 = now_seconds();
+    ok = ok && got == (int64_t)tail_size && memcmp(tail, buf + size - tail_size, tail_size) == 0;
+
+    // API strumieniowe w pamięci, bez plików
+    size_t bound = huffman_compress_bound(size, &bench_options);
+    unsigned char* packed = (unsigned char*)malloc(bound);
+    unsigned char* unpacked = (unsigned char*)malloc(size);
+    size_t packed_size = 0, unpacked_size = 0;
+    double t5 = now_seconds();
+    int mem_ok = packed && unpacked && huffman_compress_buffer(buf, size, packed, bound, &packed_size, &bench_options);
+    double t6 = now_seconds();
+    mem_ok = mem_ok && huffman_decompress_buffer(packed, packed_size, unpacked, size, &unpacked_size);
+    double t7 = now_seconds();
+    mem_ok = mem_ok && unpacked_size == size && memcmp(buf, unpacked, size) == 0;
+    free(packed);
+    free(unpacked);
+    free(buf);
+
+    double mb = (double)size / 1e6;
+    printf("%-8s %8zu B  ratio %6.3f  kompresja %9.2f MB/s  dekompresja %9.2f MB/s  ostatni 1 KB %7.3f ms  %s\n",
+           name, size, (double)file_size(BENCH_COMPRESSED) / (double)size,
+           mb / (t1 - t0), mb / (t2 - t1), (t4 - t3) * 1e3, ok ? "OK" : "BŁĄD");
+    printf("%-8s %8s    bufor w pamięci    kompresja %9.2f MB/s  dekompresja %9.2f MB/s  %s\n",
+           "", "", mb / (t6 - t5), mb / (t7 - t6), mem_ok ? "OK" : "BŁĄD");
+
+    remove(BENCH_INPUT);
+    remove(BENCH_COMPRESSED);
+    remove(BENCH_OUTPUT);
+}
+
+#define BENCH_CONTEXT_ROUNDS 5
+
+// Porównanie order-0 z trybem kontekstowym: najlepszy z BENCH_CONTEXT_ROUNDS czas kompresji,
+// przesłania łączem bench_options.link_mb_per_s i dekompresji w pamięci. Tryb "wymuszony" wybiera
+// kontekst po samym rozmiarze (link_mb_per_s = 0), co pokazuje koszt, z którego wyznaczone są
+// domyślne wartości modelu.
+static void run_context_case(const char* name, void (*generate)(unsigned char*, size_t), size_t size) {
+    unsigned char* buf = (unsigned char*)malloc(size);
+    unsigned char* unpacked = (unsigned char*)malloc(size);
+    HuffmanOptions options = bench_options;
+    options.context_tables = 0;
+    size_t bound = huffman_compress_bound(size, &options);
+    unsigned char* packed = (unsigned char*)malloc(bound);
+    if (!buf || !unpacked || !packed) {
+        free(buf);
+        free(unpacked);
+        free(packed);
+        return;
+    }
+    generate(buf, size);
+
+    static const char* modes[] = {"order-0", "kontekst", "wymuszony"};
+    double mb = (double)size / 1e6;
+    for (int mode = 0; mode < 3; mode++) {
+        options.context_tables = mode == 0 ? 0 : HUFFMAN_MAX_CONTEXTS;
+        options.link_mb_per_s = mode == 2 ? 0 : bench_options.link_mb_per_s;
+        size_t packed_size = 0, unpacked_size = 0;
+        double compress = 0, decompress = 0;
+        int ok = 1;
+        for (int r = 0; ok && r < BENCH_CONTEXT_ROUNDS; r++) {
+            double t0 = now_seconds();
+            ok = huffman_compress_buffer(buf, size, packed, bound, &packed_size, &options);
+            double t1 = now_seconds();
+            ok = ok && huffman_decompress_buffer(packed, packed_size, unpacked, size, &unpacked_size);
+            double t2 = now_seconds();
+            if (r == 0 || t1 - t0 < compress) compress = t1 - t0;
+            if (r == 0 || t2 - t1 < decompress) decompress = t2 - t1;
+        }
+        ok = ok && unpacked_size == size && memcmp(buf, unpacked, size) == 0;
+
+        double link = bench_options.link_mb_per_s;
+        double transfer = link > 0 ? (double)packed_size / 1e6 / link : 0;
+        printf("%-8s %-9s ratio %6.3f  kompresja %9.2f MB/s  dekompresja %9.2f MB/s  "
+               "kompresja+przesłanie+dekompresja %8.2f ms  %s\n",
+               name, modes[mode], (double)packed_size / (double)size, mb / compress, mb / decompress,
+               (compress + transfer + decompress) * 1e3, ok ? "OK" : "BŁĄD");
+    }
+
+    free(buf);
+    free(unpacked);
+    free(packed);
+}
+
+#define BENCH_FLUSH_SIZE 4096
+
+// Kompresja strumieniowa z flush co BENCH_FLUSH_SIZE bajtów (jak dla napływającego logu)
+static int compress_flushing(const unsigned char* in, size_t size, unsigned char* out, size_t capacity,
+                             size_t* out_size, const HuffmanOptions* options) {
+    HuffmanEncoder* encoder = huffman_encoder_create(options);
+    if (!encoder) return 0;
+
+    size_t total = 0, consumed, produced;
+    int ok = 1;
+    for (size_t pos = 0; ok && pos < size; pos += BENCH_FLUSH_SIZE) {
+        size_t n = size - pos < BENCH_FLUSH_SIZE ? size - pos : BENCH_FLUSH_SIZE;
+        ok = huffman_encoder_update(encoder, in + pos, n, &consumed, out + total, capacity - total, &produced) == HUFFMAN_STREAM_DONE;
+        total += produced;
+        ok = ok && huffman_encoder_flush(encoder, out + total, capacity - total, &produced) == HUFFMAN_STREAM_DONE;
+        total += produced;
+    }
+    ok = ok && huffman_encoder_finish(encoder, out + total, capacity - total, &produced) == HUFFMAN_STREAM_DONE;
+    total += produced;
+    huffman_encoder_destroy(encoder);
+
+    *out_size = total;
+    return ok;
+}
+
+// Porównanie kodów statycznych (histogram bloku) z trybem adaptacyjnym (jeden przebieg)
+static void run_adaptive_case(const char* name, void (*generate)(unsigned char*, size_t), size_t size) {
+    unsigned char* buf = (unsigned char*)malloc(size);
+    unsigned char* unpacked = (unsigned char*)malloc(size);
+    HuffmanOptions options = bench_options;
+    options.context_tables = 0;
+    options.adaptive_interval = 0;
+    // Blok na każdy flush: nagłówek i tablica (albo start od równych liczników) za każde 4 KB
+    size_t bound = huffman_compress_bound(size, &options) +
+                   (size / BENCH_FLUSH_SIZE + 1) * huffman_block_bound(BENCH_FLUSH_SIZE, &options);
+    unsigned char* packed = (unsigned char*)malloc(bound);
+    if (!buf || !unpacked || !packed) {
+        free(buf);
+        free(unpacked);
+        free(packed);
+        return;
+    }
+    generate(buf, size);
+
+    double mb = (double)size / 1e6;
+    for (int mode = 0; mode < 2; mode++) {
+        options.adaptive_interval = mode == 0 ? 0 : 65536;
+        size_t packed_size = 0, flushed_size = 0, unpacked_size = 0;
+        double t0 = now_seconds();
+        int ok = huffman_compress_buffer(buf, size, packed, bound, &packed_size, &options);
+        double t1 = now_seconds();
+        ok = ok && huffman_decompress_buffer(packed, packed_size, unpacked, size, &unpacked_size);
+        double t2 = now_seconds();
+        ok = ok && unpacked_size == size && memcmp(buf, unpacked, size) == 0;
+
+        ok = ok && compress_flushing(buf, size, packed, bound, &flushed_size, &options);
+        ok = ok && huffman_decompress_buffer(packed, flushed_size, unpacked, size, &unpacked_size);
+        ok = ok && unpacked_size == size && memcmp(buf, unpacked, size) == 0;
+
+        printf("%-8s %-11s ratio %6.3f  kompresja %9.2f MB/s  dekompresja %9.2f MB/s  ratio z flush co %d B %6.3f  %s\n",
+               name, mode == 0 ? "statyczny" : "adaptacyjny", (double)packed_size / (double)size,
+               mb / (t1 - t0), mb / (t2 - t1), BENCH_FLUSH_SIZE, (double)flushed_size / (double)size, ok ? "OK" : "BŁĄD");
+    }
+
+    free(buf);
+    free(unpacked);
+    free(packed);
+}
+
+#define BENCH_TREE_ROUNDS 20000
+
+// Kod pełny: suma 2^-długość po użytych symbolach równa 1 (liczona w jednostkach 2^-63)
+static int complete_code(const HuffmanCode codes[]) {
+    uint64_t kraft = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (codes[i].length > 0) kraft += (uint64_t)1 << (63 - codes[i].length);
+    }
+    return kraft == (uint64_t)1 << 63;
+}
+
+// Długości kodów dla alfabetu o `symbols` symbolach; do HUFFMAN_HEAP_MAX_SYMBOLS liczy je kopiec
+// typowany, powyżej algorytm w miejscu. `base` przesuwa liczniki ponad 2^32 (sumy 64-bitowe)
+static void run_tree_case(int symbols, uint64_t base) {
+    uint64_t frequencies[MAX_CHARS] = {0};
+    for (int i = 0; i < symbols; i++) {
+        frequencies[i * MAX_CHARS / symbols] = base + 1 + rng_next() % 100000;
+    }
+
+    HuffmanCode codes[MAX_CHARS];
+    double t0 = now_seconds();
+    for (int r = 0; r < BENCH_TREE_ROUNDS; r++) {
+        huffman_code_lengths(frequencies, codes);
+    }
+    double t1 = now_seconds();
+
+    printf("%3d symboli%s  %8.2f us  %s\n", symbols, base > UINT32_MAX ? " (2^34+)" : "        ",
+           (t1 - t0) * 1e6 / BENCH_TREE_ROUNDS, complete_code(codes) ? "OK" : "BŁĄD");
+}
+
+static void run_tree_cases(void) {
+    int sizes[] = {4, 16, 32, 40, 48, 64, 128, 256};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        run_tree_case(sizes[i], 0);
+    }
+    run_tree_case(16, (uint64_t)1 << 34);
+    run_tree_case(256, (uint64_t)1 << 34);
+}
+
+#define BENCH_MESSAGES 2000
+
+// Krótkie wiadomości: pełny format (histogram, tablica kodów, nagłówki) wobec słownika
+// wytrenowanego na pierwszej połowie danych; czasy na wiadomość (kompresja + dekompresja)
+static void run_message_case(const char* name, void (*generate)(unsigned char*, size_t), size_t size) {
+    unsigned char* buf = (unsigned char*)malloc(size);
+    HuffmanOptions options = bench_options;
+    options.threads = 1;
+    size_t bound = huffman_compress_bound(4096, &options) + huffman_block_bound(4096, &options);
+    unsigned char* packed = (unsigned char*)malloc(bound);
+    unsigned char* unpacked = (unsigned char*)malloc(4096);
+    HuffmanDictionary dict;
+    uint64_t frequencies[MAX_CHARS] = {0};
+    if (!buf || !packed || !unpacked || size < 2 * 4096) {
+        free(buf);
+        free(packed);
+        free(unpacked);
+        return;
+    }
+    generate(buf, size);
+    for (size_t i = 0; i < size / 2; i++) frequencies[buf[i]]++;
+    if (!huffman_dictionary_train(&dict, 0, frequencies, options.max_code_length)) {
+        free(buf);
+        free(packed);
+        free(unpacked);
+        return;
+    }
+
+    static const size_t message_sizes[] = {64, 256, 1024, 4096};
+    for (size_t m = 0; m < sizeof(message_sizes) / sizeof(message_sizes[0]); m++) {
+        size_t message = message_sizes[m];
+        size_t span = size / 2 - message;
+        uint64_t full_bytes = 0, dict_bytes = 0;
+        int ok = 1;
+
+        double t0 = now_seconds();
+        for (int k = 0; ok && k < BENCH_MESSAGES; k++) {
+            const unsigned char* msg = buf + size / 2 + (size_t)k * 997 % span;
+            size_t packed_size = 0, unpacked_size = 0;
+            ok = huffman_compress_buffer(msg, message, packed, bound, &packed_size, &options) &&
+                 huffman_decompress_buffer(packed, packed_size, unpacked, message, &unpacked_size) &&
+                 unpacked_size == message && memcmp(msg, unpacked, message) == 0;
+            full_bytes += packed_size;
+        }
+        double t1 = now_seconds();
+        for (int k = 0; ok && k < BENCH_MESSAGES; k++) {
+            const unsigned char* msg = buf + size / 2 + (size_t)k * 997 % span;
+            size_t packed_size = huffman_encode_message(&dict, msg, message, packed), unpacked_size = 0;
+            ok = huffman_decode_message(&dict, packed, packed_size, unpacked, message, &unpacked_size) &&
+                 unpacked_size == message && memcmp(msg, unpacked, message) == 0;
+            dict_bytes += packed_size;
+        }
+        double t2 = now_seconds();
+
+        double total = (double)message * BENCH_MESSAGES;
+        printf("%-8s %5zu B  pełny format: ratio %6.3f %8.2f us  słownik: ratio %6.3f %8.2f us  %s\n",
+               name, message, (double)full_bytes / total, (t1 - t0) * 1e6 / BENCH_MESSAGES,
+               (double)dict_bytes / total, (t2 - t1) * 1e6 / BENCH_MESSAGES, ok ? "OK" : "BŁĄD");
+    }
+
+    huffman_dictionary_free(&dict);
+    free(buf);
+    free(packed);
+    free(unpacked);
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = 1 << 20;
+    if (argc > 1) {
+        size = (size_t)strtoull(argv[1], NULL, 10);
+        if (size == 0) size = 1 << 20;
+    }
+
+    huffman_default_options(&bench_options);
+    bench_options.quiet = 1;
+    if (argc > 2) {
+        bench_options.max_code_length = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        bench_options.block_size = (size_t)strtoull(argv[3], NULL, 10);
+    }
+    if (argc > 4) {
+        bench_options.threads = atoi(argv[4]);
+    }
+    printf("Limit długości kodu: %d, blok: %zu B, wątki: %d\n",
+           bench_options.max_code_length, bench_options.block_size, bench_options.threads);
+
+    run_case("tekst", generate_text, size);
+    run_case("skośne", generate_skewed, size);
+    run_case("losowe", generate_random, size);
+
+    printf("Tryb kontekstowy (%d tablic), łącze %.0f MB/s:\n", HUFFMAN_MAX_CONTEXTS, bench_options.link_mb_per_s);
+    run_context_case("tekst", generate_text, size);
+    run_context_case("skośne", generate_skewed, size);
+
+    printf("Tryb adaptacyjny (przebudowa kodów co 65536 B):\n");
+    run_adaptive_case("tekst", generate_text, size);
+    run_adaptive_case("skośne", generate_skewed, size);
+
+    printf("Budowa kodów (%d powtórzeń):\n", BENCH_TREE_ROUNDS);
+    run_tree_cases();
+
+    printf("Krótkie wiadomości (%d na rozmiar, słownik z próbek tego samego źródła):\n", BENCH_MESSAGES);
+    run_message_case("tekst", generate_text, size);
+    run_message_case("skośne", generate_skewed, size);
+    return 0;
+}
@@ -0,0 +1,316 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "huffman.h"
+
+// Zestaw pomiarowy: powtarzalne korpusy syntetyczne od 1 KB do 1 GB, kompresja i dekompresja
+// mierzone osobno, każda w osobnym procesie (szczytowe RSS dotyczy tylko tej fazy).
+// Wynik w formacie CSV na stdout, do porównywania kolejnych wersji.
+
+#define SUITE_INPUT "suite_input.tmp"
+#define SUITE_COMPRESSED "suite_compressed.tmp"
+#define SUITE_OUTPUT "suite_output.tmp"
+
+#define SUITE_MIN_SIZE ((uint64_t)1 << 10)
+#define SUITE_MAX_SIZE ((uint64_t)1 << 30)
+#define SUITE_DEFAULT_MAX_SIZE ((uint64_t)64 << 20)
+#define SUITE_SIZE_STEP 16               // Kolejne rozmiary: 1 KB, 16 KB, 256 KB, 4 MB, 64 MB, 1 GB
+#define SUITE_CHUNK (1 << 16)            // Korpus generowany i porównywany kawałkami (małe RSS rodzica)
+#define SUITE_MIN_SECONDS 0.2            // Małe wejścia powtarzane, aż pomiar potrwa co najmniej tyle
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Generatory dostają kolejne kawałki korpusu; `offset` to położenie kawałka w korpusie
+static void generate_uniform(unsigned char* buf, size_t size, uint64_t offset) {
+    (void)offset;
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (unsigned char)rng_next();
+    }
+}
+
+// Rozkład Zipfa (s = 1) na 256 symbolach, losowanie przez dystrybuantę
+static void generate_zipf(unsigned char* buf, size_t size, uint64_t offset) {
+    static double cdf[MAX_CHARS];
+    if (offset == 0) {
+        double sum = 0;
+        for (int i = 0; i < MAX_CHARS; i++) sum += 1.0 / (i + 1);
+        double acc = 0;
+        for (int i = 0; i < MAX_CHARS; i++) {
+            acc += 1.0 / (i + 1) / sum;
+            cdf[i] = acc;
+        }
+        cdf[MAX_CHARS - 1] = 1.0;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        double u = (double)(rng_next() >> 11) * (1.0 / 9007199254740992.0);
+        int lo = 0, hi = MAX_CHARS - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        buf[i] = (unsigned char)lo;
+    }
+}
+
+// Słowa o częstościach zbliżonych do angielskich, interpunkcja i nowe linie
+static void generate_english(unsigned char* buf, size_t size, uint64_t offset) {
+    static const char* words[] = {
+        "the", "of", "and", "to", "a", "in", "is", "that", "for", "it",
+        "as", "was", "with", "be", "by", "on", "not", "he", "this", "are",
+        "or", "his", "from", "at", "which", "but", "have", "an", "had", "they",
+        "you", "were", "their", "one", "all", "we", "can", "her", "has", "there",
+        "been", "if", "more", "when", "will", "would", "who", "so", "no", "people",
+        "compression", "message", "between", "through", "government", "information"
+    };
+    static size_t word_pos = 0;
+    static const char* word = NULL;
+    if (offset == 0) word = NULL;
+
+    size_t n = sizeof(words) / sizeof(words[0]);
+    for (size_t i = 0; i < size; i++) {
+        if (!word || word[word_pos] == '\0') {
+            if (word) {
+                uint64_t r = rng_next() % 40;
+                buf[i] = r == 0 ? '\n' : r == 1 ? ',' : r == 2 ? '.' : ' ';
+                word = NULL;
+                continue;
+            }
+            // Słowa z początku listy są częstsze (w przybliżeniu rozkład Zipfa)
+            uint64_t r = rng_next();
+            word = words[(r % n) * ((r >> 32) % n) / n];
+            word_pos = 0;
+        }
+        buf[i] = (unsigned char)word[word_pos++];
+    }
+}
+
+// Krótki losowy fragment powtarzany z rzadkimi zmianami
+static void generate_repetitive(unsigned char* buf, size_t size, uint64_t offset) {
+    static unsigned char pattern[61];
+    if (offset == 0) {
+        for (size_t i = 0; i < sizeof(pattern); i++) pattern[i] = (unsigned char)('a' + rng_next() % 26);
+    }
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = pattern[(offset + i) % sizeof(pattern)];
+        if (rng_next() % 4096 == 0) buf[i] ^= 0x20;
+    }
+}
+
+static void generate_single(unsigned char* buf, size_t size, uint64_t offset) {
+    (void)offset;
+    memset(buf, 'A', size);
+}
+
+// Wszystkie 256 symboli po równo, w kolejności zmienianej co 256 bajtów
+static void generate_all256(unsigned char* buf, size_t size, uint64_t offset) {
+    for (size_t i = 0; i < size; i++) {
+        uint64_t pos = offset + i;
+        buf[i] = (unsigned char)(pos + (pos >> 8) * 97);
+    }
+}
+
+typedef struct {
+    const char* name;
+    void (*generate)(unsigned char*, size_t, uint64_t);
+} Corpus;
+
+static const Corpus corpora[] = {
+    {"uniform", generate_uniform},
+    {"zipf", generate_zipf},
+    {"english", generate_english},
+    {"repetitive", generate_repetitive},
+    {"single", generate_single},
+    {"all256", generate_all256}
+};
+
+static int write_corpus(const Corpus* corpus, uint64_t size, unsigned char* chunk) {
+    FILE* f = fopen(SUITE_INPUT, "wb");
+    if (!f) return 0;
+
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    int ok = 1;
+    for (uint64_t offset = 0; offset < size && ok; offset += SUITE_CHUNK) {
+        size_t n = size - offset < SUITE_CHUNK ? (size_t)(size - offset) : SUITE_CHUNK;
+        corpus->generate(chunk, n, offset);
+        ok = fwrite(chunk, 1, n, f) == n;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+static int files_equal(const char* a, const char* b, unsigned char* chunk_a, unsigned char* chunk_b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    int equal = fa && fb;
+    while (equal) {
+        size_t na = fread(chunk_a, 1, SUITE_CHUNK, fa);
+        size_t nb = fread(chunk_b, 1, SUITE_CHUNK, fb);
+        if (na != nb || memcmp(chunk_a, chunk_b, na) != 0) equal = 0;
+        if (na < SUITE_CHUNK) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return equal;
+}
+
+static long file_size(const char* name) {
+    FILE* f = fopen(name, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+typedef struct {
+    int ok;
+    int runs;
+    double seconds;       // Średni czas jednego przebiegu
+    long peak_rss_kb;
+} PhaseResult;
+
+// Uruchamia fazę w procesie potomnym (komunikaty biblioteki trafiają do /dev/null)
+static PhaseResult run_phase(int decompress, const HuffmanOptions* options) {
+    PhaseResult result = {0, 0, 0.0, 0};
+    int fds[2];
+    if (pipe(fds) != 0) return result;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        if (!freopen("/dev/null", "w", stdout)) _exit(1);
+
+        double start = now_seconds(), elapsed = 0;
+        int ok = 1;
+        do {
+            ok = decompress ? huffman_decompress_with_options(SUITE_COMPRESSED, SUITE_OUTPUT, options)
+                            : huffman_compress_with_options(SUITE_INPUT, SUITE_COMPRESSED, options);
+            result.runs++;
+            elapsed = now_seconds() - start;
+        } while (ok && elapsed < SUITE_MIN_SECONDS);
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        result.ok = ok;
+        result.seconds = elapsed / result.runs;
+        result.peak_rss_kb = usage.ru_maxrss;
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    PhaseResult child;
+    if (read(fds[0], &child, sizeof(child)) == (ssize_t)sizeof(child)) result = child;
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) result.ok = 0;
+    return result;
+}
+
+static void print_phase(const char* corpus, uint64_t size, const char* phase, const PhaseResult* r, double ratio) {
+    double mb_s = r->seconds > 0 ? (double)size / 1e6 / r->seconds : 0;
+    double ns_per_byte = (double)r->seconds * 1e9 / (double)size;
+    printf("%s,%llu,%s,%.2f,%.3f,%ld,%.4f,%d,%s\n", corpus, (unsigned long long)size, phase,
+           mb_s, ns_per_byte, r->peak_rss_kb, ratio, r->runs, r->ok ? "OK" : "BLAD");
+}
+
+static uint64_t parse_size(const char* text) {
+    char* end;
+    double value = strtod(text, &end);
+    if (*end == 'K' || *end == 'k') value *= 1024.0;
+    if (*end == 'M' || *end == 'm') value *= 1024.0 * 1024.0;
+    if (*end == 'G' || *end == 'g') value *= 1024.0 * 1024.0 * 1024.0;
+    return value > 0 ? (uint64_t)value : 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Argumenty: największy rozmiar korpusu (np. 64M, 1G), liczba wątków, wybrany korpus
+    uint64_t max_size = SUITE_DEFAULT_MAX_SIZE;
+    if (argc > 1) {
+        max_size = parse_size(argv[1]);
+        if (max_size < SUITE_MIN_SIZE || max_size > SUITE_MAX_SIZE) {
+            printf("Błąd: Rozmiar musi być z zakresu 1K-1G!\n");
+            return 1;
+        }
+    }
+
+    HuffmanOptions options;
+    huffman_default_options(&options);
+    if (argc > 2) options.threads = atoi(argv[2]);
+    const char* only = argc > 3 ? argv[3] : NULL;
+
+    unsigned char* chunk_a = (unsigned char*)malloc(SUITE_CHUNK);
+    unsigned char* chunk_b = (unsigned char*)malloc(SUITE_CHUNK);
+    if (!chunk_a || !chunk_b) {
+        printf("Błąd: Brak pamięci!\n");
+        return 1;
+    }
+
+    // Nagłówek CSV; linie zaczynające się od '#' są komentarzami
+    printf("# huffman suite: format %d, blok %zu B, limit kodu %d, wątki %d\n", HUFFMAN_FORMAT_VERSION,
+           options.block_size, options.max_code_length, options.threads);
+    printf("corpus,size,phase,mb_s,ns_per_byte,peak_rss_kb,ratio,runs,status\n");
+    fflush(stdout);
+
+    int failures = 0;
+    for (size_t c = 0; c < sizeof(corpora) / sizeof(corpora[0]); c++) {
+        if (only && strcmp(only, corpora[c].name) != 0) continue;
+
+        for (uint64_t size = SUITE_MIN_SIZE; size <= max_size; size *= SUITE_SIZE_STEP) {
+            if (!write_corpus(&corpora[c], size, chunk_a)) {
+                printf("Błąd: Nie udało się zapisać korpusu!\n");
+                failures++;
+                break;
+            }
+
+            PhaseResult compress = run_phase(0, &options);
+            double ratio = (double)file_size(SUITE_COMPRESSED) / (double)size;
+            PhaseResult decompress = run_phase(1, &options);
+            decompress.ok = decompress.ok && compress.ok && files_equal(SUITE_INPUT, SUITE_OUTPUT, chunk_a, chunk_b);
+
+            print_phase(corpora[c].name, size, "compress", &compress, ratio);
+            print_phase(corpora[c].name, size, "decompress", &decompress, ratio);
+            fflush(stdout);
+            failures += !compress.ok + !decompress.ok;
+        }
+    }
+
+    remove(SUITE_INPUT);
+    remove(SUITE_COMPRESSED);
+    remove(SUITE_OUTPUT);
+    free(chunk_a);
+    free(chunk_b);
+    return failures == 0 ? 0 : 1;
+}
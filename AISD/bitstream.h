@@ -0,0 +1,134 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Czytnik strumienia bitów (MSB first) z buforem 64-bitowym.
+// Bity w buforze są wyrównane do lewej: najstarszy bit to następny bit strumienia.
+typedef struct {
+    const unsigned char* data;
+    size_t size;          // Rozmiar danych w bajtach
+    size_t pos;           // Następny bajt do załadowania
+    uint64_t buffer;      // Załadowane, jeszcze niezużyte bity
+    int count;            // Liczba ważnych bitów w buforze
+} BitReader;
+
+static inline uint64_t bitstream_load_be64(const unsigned char* p) {
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+           ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+           ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+           ((uint64_t)p[6] << 8)  |  (uint64_t)p[7];
+}
+
+static inline void bitreader_init(BitReader* br, const unsigned char* data, size_t size) {
+    br->data = data;
+    br->size = size;
+    br->pos = 0;
+    br->buffer = 0;
+    br->count = 0;
+}
+
+// Uzupełnia bufor do co najmniej 57 bitów. Za końcem danych dokładane są zera.
+static inline void bitreader_refill(BitReader* br) {
+    if (br->pos + 8 <= br->size) {
+        br->buffer |= bitstream_load_be64(br->data + br->pos) >> br->count;
+        br->pos += (size_t)((63 - br->count) >> 3);
+        br->count |= 56;
+        return;
+    }
+    while (br->count <= 56) {
+        uint64_t byte = br->pos < br->size ? br->data[br->pos] : 0;
+        br->buffer |= byte << (56 - br->count);
+        br->pos++;
+        br->count += 8;
+    }
+}
+
+static inline uint32_t bitreader_peek(const BitReader* br, int bits) {
+    return (uint32_t)(br->buffer >> (64 - bits));
+}
+
+static inline void bitreader_consume(BitReader* br, int bits) {
+    br->buffer <<= bits;
+    br->count -= bits;
+}
+
+// Liczba bitów zużytych od początku strumienia
+static inline uint64_t bitreader_position(const BitReader* br) {
+    return (uint64_t)br->pos * 8 - (uint64_t)br->count;
+}
+
+// Pisarz strumienia bitów (MSB first). Bity gromadzone są w 64-bitowym akumulatorze
+// (wyrównane do prawej) i zapisywane całymi słowami 32-bitowymi.
+// Wywołujący dba o to, aby w `data` zostały co najmniej 4 wolne bajty przed każdym zapisem.
+typedef struct {
+    unsigned char* data;
+    size_t pos;           // Liczba zapisanych bajtów
+    uint64_t buffer;      // Bity oczekujące na zapis
+    int count;            // Liczba bitów w akumulatorze (zawsze < 32 między wywołaniami)
+} BitWriter;
+
+static inline void bitwriter_init(BitWriter* bw, unsigned char* data) {
+    bw->data = data;
+    bw->pos = 0;
+    bw->buffer = 0;
+    bw->count = 0;
+}
+
+static inline void bitstream_store_be32(unsigned char* p, uint32_t value) {
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+// Dopisuje kod o długości 1..32 bitów jednym przesunięciem i OR
+static inline void bitwriter_put(BitWriter* bw, uint64_t bits, int length) {
+    bw->buffer = (bw->buffer << length) | bits;
+    bw->count += length;
+    if (bw->count >= 32) {
+        bw->count -= 32;
+        bitstream_store_be32(bw->data + bw->pos, (uint32_t)(bw->buffer >> bw->count));
+        bw->pos += 4;
+    }
+}
+
+// Przenosi całe bajty z akumulatora do bufora (pozostaje mniej niż 8 bitów)
+static inline void bitwriter_flush_bytes(BitWriter* bw) {
+    while (bw->count >= 8) {
+        bw->count -= 8;
+        bw->data[bw->pos++] = (unsigned char)(bw->buffer >> bw->count);
+    }
+}
+
+// Zapisuje resztę bitów, dopełniając ostatni bajt zerami. Zwraca liczbę bitów dopełnienia.
+static inline int bitwriter_finish(BitWriter* bw) {
+    bitwriter_flush_bytes(bw);
+    int padding = 0;
+    if (bw->count > 0) {
+        padding = 8 - bw->count;
+        bw->data[bw->pos++] = (unsigned char)(bw->buffer << padding);
+        bw->count = 0;
+    }
+    return padding;
+}
+
+// Liczby w nagłówkach formatu zapisywane są jako little-endian
+static inline void bitstream_store_le32(unsigned char* p, uint32_t value) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static inline void bitstream_store_le64(unsigned char* p, uint64_t value) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static inline uint32_t bitstream_load_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t bitstream_load_le64(const unsigned char* p) {
+    return (uint64_t)bitstream_load_le32(p) | ((uint64_t)bitstream_load_le32(p + 4) << 32);
+}
+
+#endif // BITSTREAM_H
@@ -0,0 +1,85 @@
+#include "checksum.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_X86 1
+#include <nmmintrin.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78u   // Wielomian Castagnoli w postaci odwróconej
+
+static uint32_t crc32c_table[8][256];
+static uint32_t (*crc32c_impl)(uint32_t crc, const unsigned char* p, size_t size);
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+// Slicing-by-8: osiem bajtów na iterację, tablica k przesuwa bajt o k pozycji dalej
+static uint32_t crc32c_slicing8(uint32_t crc, const unsigned char* p, size_t size) {
+    while (size >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        uint32_t hi = (uint32_t)p[4] | (uint32_t)p[5] << 8 | (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24;
+        crc = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF] ^
+              crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24] ^
+              crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF] ^
+              crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = crc32c_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef CHECKSUM_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t size) {
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, p, 4);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        size -= 4;
+    }
+    while (size--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+static void crc32c_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        crc32c_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            crc32c_table[k][i] = crc32c_table[0][crc32c_table[k - 1][i] & 0xFF] ^ (crc32c_table[k - 1][i] >> 8);
+        }
+    }
+
+    crc32c_impl = crc32c_slicing8;
+#ifdef CHECKSUM_X86
+    if (__builtin_cpu_supports("sse4.2")) crc32c_impl = crc32c_sse42;
+#endif
+}
+
+uint32_t checksum_crc32c(uint32_t crc, const void* data, size_t size) {
+    pthread_once(&crc32c_once, crc32c_init);
+    return ~crc32c_impl(~crc, (const unsigned char*)data, size);
+}
@@ -0,0 +1,13 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHECKSUM_CRC32C_INIT 0u
+
+// CRC-32C (Castagnoli), liczona przyrostowo: wynik poprzedniego wywołania jest wejściem następnego.
+// Na x86 z SSE4.2 używa instrukcji crc32, w przeciwnym razie tablic slicing-by-8.
+uint32_t checksum_crc32c(uint32_t crc, const void* data, size_t size);
+
+#endif // CHECKSUM_H
@@ -0,0 +1,159 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent_pq.h"
+#include "priority_queue.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPQ_CACHE_LINE 64
+#define CPQ_TRY_LOCKS 4       // Próby trylock przed czekaniem na zamek
+#define CPQ_EMPTY INT_MAX     // Zapamiętane minimum pustej kolejki
+
+// Każda kolejka zajmuje osobne linie pamięci podręcznej
+typedef struct {
+    _Alignas(CPQ_CACHE_LINE) pthread_mutex_t lock;
+    PriorityQueue* pq;
+    _Atomic int top;          // Najmniejszy priorytet (odczytywany bez zamka)
+} CPQShard;
+
+struct ConcurrentPQ {
+    CPQShard* shards;
+    size_t shard_count;
+    _Alignas(CPQ_CACHE_LINE) atomic_size_t size;
+};
+
+static _Thread_local uint64_t rng_state;
+
+static size_t random_shard(const ConcurrentPQ* cpq) {
+    if (rng_state == 0) {
+        // Ziarno z adresu zmiennej wątku: różne dla każdego wątku
+        rng_state = (uint64_t)(uintptr_t)&rng_state * 0x9E3779B97F4A7C15ULL | 1;
+    }
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (size_t)(rng_state % cpq->shard_count);
+}
+
+// Wywoływana z zablokowanym zamkiem kolejki
+static void update_top(CPQShard* shard) {
+    int top = pq_is_empty(shard->pq) ? CPQ_EMPTY : shard->pq->priorities[0];
+    atomic_store_explicit(&shard->top, top, memory_order_relaxed);
+}
+
+ConcurrentPQ* cpq_create(size_t shards) {
+    if (shards == 0) return NULL;
+
+    ConcurrentPQ* cpq = (ConcurrentPQ*)aligned_alloc(CPQ_CACHE_LINE, sizeof(ConcurrentPQ));
+    if (!cpq) return NULL;
+    memset(cpq, 0, sizeof(ConcurrentPQ));
+    atomic_init(&cpq->size, 0);
+
+    cpq->shards = (CPQShard*)aligned_alloc(CPQ_CACHE_LINE, shards * sizeof(CPQShard));
+    if (!cpq->shards) {
+        free(cpq);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < shards; i++) {
+        CPQShard* shard = &cpq->shards[i];
+        shard->pq = pq_create(0);
+        atomic_init(&shard->top, CPQ_EMPTY);
+        if (!shard->pq || pthread_mutex_init(&shard->lock, NULL) != 0) {
+            pq_destroy(shard->pq);
+            cpq->shard_count = i;
+            cpq_destroy(cpq);
+            return NULL;
+        }
+        cpq->shard_count = i + 1;
+    }
+
+    return cpq;
+}
+
+void cpq_destroy(ConcurrentPQ* cpq) {
+    if (!cpq) return;
+    for (size_t i = 0; i < cpq->shard_count; i++) {
+        pthread_mutex_destroy(&cpq->shards[i].lock);
+        pq_destroy(cpq->shards[i].pq);
+    }
+    free(cpq->shards);
+    free(cpq);
+}
+
+// Blokuje losową kolejkę; najpierw próbuje kilku bez czekania
+static CPQShard* lock_random_shard(ConcurrentPQ* cpq) {
+    for (int attempt = 0; attempt < CPQ_TRY_LOCKS; attempt++) {
+        CPQShard* shard = &cpq->shards[random_shard(cpq)];
+        if (pthread_mutex_trylock(&shard->lock) == 0) return shard;
+    }
+    CPQShard* shard = &cpq->shards[random_shard(cpq)];
+    pthread_mutex_lock(&shard->lock);
+    return shard;
+}
+
+int cpq_add(ConcurrentPQ* cpq, void* data, int priority) {
+    if (!cpq || !data) return 0;
+
+    CPQShard* shard = lock_random_shard(cpq);
+    int ok = pq_add(shard->pq, data, priority) != PQ_INVALID_HANDLE;
+    if (ok) {
+        if (priority < atomic_load_explicit(&shard->top, memory_order_relaxed)) {
+            atomic_store_explicit(&shard->top, priority, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&cpq->size, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return ok;
+}
+
+// Zdejmuje minimum z zablokowanej kolejki i zwalnia zamek; NULL, gdy kolejka była pusta
+static void* pop_locked(ConcurrentPQ* cpq, CPQShard* shard) {
+    void* data = NULL;
+    if (!pq_is_empty(shard->pq)) {
+        data = pq_remove(shard->pq);
+        update_top(shard);
+        atomic_fetch_sub_explicit(&cpq->size, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return data;
+}
+
+void* cpq_remove(ConcurrentPQ* cpq) {
+    if (!cpq) return NULL;
+
+    while (atomic_load_explicit(&cpq->size, memory_order_relaxed) > 0) {
+        // Lepsza z dwóch losowych kolejek
+        for (int attempt = 0; attempt < CPQ_TRY_LOCKS; attempt++) {
+            CPQShard* a = &cpq->shards[random_shard(cpq)];
+            CPQShard* b = &cpq->shards[random_shard(cpq)];
+            int top_a = atomic_load_explicit(&a->top, memory_order_relaxed);
+            int top_b = atomic_load_explicit(&b->top, memory_order_relaxed);
+            CPQShard* best = top_b < top_a ? b : a;
+            if ((top_a == CPQ_EMPTY && top_b == CPQ_EMPTY) || pthread_mutex_trylock(&best->lock) != 0) {
+                continue;
+            }
+
+            void* data = pop_locked(cpq, best);
+            if (data) return data;
+        }
+
+        // Losowe kolejki są puste albo zajęte: przegląd wszystkich po kolei
+        for (size_t i = 0; i < cpq->shard_count; i++) {
+            CPQShard* shard = &cpq->shards[i];
+            pthread_mutex_lock(&shard->lock);
+            void* data = pop_locked(cpq, shard);
+            if (data) return data;
+        }
+    }
+
+    return NULL;
+}
+
+size_t cpq_size(ConcurrentPQ* cpq) {
+    return cpq ? atomic_load_explicit(&cpq->size, memory_order_relaxed) : 0;
+}
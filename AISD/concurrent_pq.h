@@ -0,0 +1,20 @@
+#ifndef CONCURRENT_PQ_H
+#define CONCURRENT_PQ_H
+
+#include <stddef.h>
+
+// Współbieżna kolejka priorytetowa (MultiQueue): `shards` kolejek PriorityQueue, każda z własnym
+// zamkiem. Wstawianie trafia do losowej kolejki; usuwanie wybiera lepszą z dwóch losowych kolejek
+// (porównując zapamiętane minima), więc zwraca element bliski minimum, niekoniecznie minimalny.
+// Przy jednej kolejce zachowuje się jak PriorityQueue chroniona mutexem. Dane nie mogą być NULL
+// (NULL z cpq_remove oznacza pustą kolejkę).
+typedef struct ConcurrentPQ ConcurrentPQ;
+
+// Funkcje kolejki współbieżnej (bezpieczne dla wielu wątków naraz, poza create/destroy)
+ConcurrentPQ* cpq_create(size_t shards);
+void cpq_destroy(ConcurrentPQ* cpq);
+int cpq_add(ConcurrentPQ* cpq, void* data, int priority);
+void* cpq_remove(ConcurrentPQ* cpq);
+size_t cpq_size(ConcurrentPQ* cpq);
+
+#endif // CONCURRENT_PQ_H
@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "concurrent_pq.h"
+
+#define CPQ_BENCH_MAX_THREADS 64
+#define CPQ_BENCH_OPS 2000000      // Łączna liczba par wstaw/usuń dla jednego pomiaru
+#define CPQ_BENCH_PREFILL 100000
+#define CPQ_BENCH_SHARDS_PER_THREAD 4
+
+typedef struct {
+    ConcurrentPQ* cpq;
+    atomic_uchar* seen;           // Ile razy zdjęto element o danym id
+    size_t first_id;              // Id elementów wstawianych przez wątek
+    size_t ops;
+    uint64_t rng;
+    atomic_int* errors;
+} Worker;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_next(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Elementy to id + 1 zapisane we wskaźniku (dane nie mogą być NULL)
+static void mark_seen(atomic_uchar* seen, void* data, atomic_int* errors) {
+    size_t id = (size_t)(uintptr_t)data - 1;
+    if (atomic_fetch_add(&seen[id], 1) != 0) atomic_fetch_add(errors, 1);
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = (Worker*)arg;
+    for (size_t i = 0; i < w->ops; i++) {
+        size_t id = w->first_id + i;
+        if (!cpq_add(w->cpq, (void*)(uintptr_t)(id + 1), (int)(rng_next(&w->rng) >> 34))) {
+            atomic_fetch_add(w->errors, 1);
+        }
+        void* data = cpq_remove(w->cpq);
+        if (data) mark_seen(w->seen, data, w->errors);
+    }
+    return NULL;
+}
+
+// Jeden pomiar: wątki na przemian wstawiają i zdejmują, potem kolejka jest opróżniana
+// i każdy element musi zostać zdjęty dokładnie raz
+static int run(int threads, size_t shards, size_t ops, double* mops) {
+    size_t per_thread = ops / (size_t)threads;
+    size_t total = CPQ_BENCH_PREFILL + per_thread * (size_t)threads;
+    ConcurrentPQ* cpq = cpq_create(shards);
+    atomic_uchar* seen = (atomic_uchar*)calloc(total, sizeof(atomic_uchar));
+    if (!cpq || !seen) {
+        cpq_destroy(cpq);
+        free(seen);
+        return 0;
+    }
+
+    atomic_int errors;
+    atomic_init(&errors, 0);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < CPQ_BENCH_PREFILL; i++) {
+        cpq_add(cpq, (void*)(uintptr_t)(i + 1), (int)(rng_next(&rng) >> 34));
+    }
+
+    Worker workers[CPQ_BENCH_MAX_THREADS];
+    pthread_t ids[CPQ_BENCH_MAX_THREADS];
+    double t0 = now_seconds();
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].cpq = cpq;
+        workers[t].seen = seen;
+        workers[t].first_id = CPQ_BENCH_PREFILL + (size_t)t * per_thread;
+        workers[t].ops = per_thread;
+        workers[t].rng = 0x2545F4914F6CDD1DULL * (uint64_t)(t + 1);
+        workers[t].errors = &errors;
+        if (pthread_create(&ids[t], NULL, worker_main, &workers[t]) != 0) break;
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    double t1 = now_seconds();
+
+    void* data;
+    while ((data = cpq_remove(cpq)) != NULL) {
+        mark_seen(seen, data, &errors);
+    }
+    int ok = started == threads && atomic_load(&errors) == 0 && cpq_size(cpq) == 0;
+    for (size_t i = 0; ok && i < total; i++) {
+        if (atomic_load(&seen[i]) != 1) ok = 0;
+    }
+
+    *mops = 2.0 * (double)(per_thread * (size_t)threads) / (t1 - t0) / 1e6;
+    cpq_destroy(cpq);
+    free(seen);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = CPQ_BENCH_MAX_THREADS;
+    size_t ops = CPQ_BENCH_OPS;
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+        if (max_threads < 1 || max_threads > CPQ_BENCH_MAX_THREADS) max_threads = CPQ_BENCH_MAX_THREADS;
+    }
+    if (argc > 2) {
+        ops = (size_t)strtoull(argv[2], NULL, 10);
+        if (ops == 0) ops = CPQ_BENCH_OPS;
+    }
+
+    // Jedna kolejka to PriorityQueue pod globalnym mutexem (punkt odniesienia)
+    printf("%7s %18s %18s\n", "wątki", "mutex Mop/s", "multiqueue Mop/s");
+    int all_ok = 1;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double global_mops = 0, sharded_mops = 0;
+        int ok = run(threads, 1, ops, &global_mops);
+        ok = run(threads, (size_t)threads * CPQ_BENCH_SHARDS_PER_THREAD, ops, &sharded_mops) && ok;
+        printf("%7d %18.2f %18.2f  %s\n", threads, global_mops, sharded_mops, ok ? "OK" : "BŁĄD");
+        all_ok = all_ok && ok;
+    }
+    return all_ok ? 0 : 1;
+}
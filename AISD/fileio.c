@@ -0,0 +1,133 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "fileio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int file_reader_open(FileReader* reader, const char* filename) {
+    reader->map = NULL;
+    reader->map_size = 0;
+    reader->pos = 0;
+    reader->error = 0;
+
+    reader->fd = open(filename, O_RDONLY);
+    if (reader->fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(reader->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+        if (map != MAP_FAILED) {
+            posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            reader->map = (const unsigned char*)map;
+            reader->map_size = (size_t)st.st_size;
+        }
+    }
+    return 1;
+}
+
+int file_reader_mapped(const FileReader* reader) {
+    return reader->map != NULL;
+}
+
+// Zwraca do `size` kolejnych bajtów. Dla zmapowanego pliku *data wskazuje bezpośrednio na mapę
+// (scratch może być NULL), w przeciwnym razie dane są czytane do `scratch`.
+size_t file_reader_read(FileReader* reader, size_t size, unsigned char* scratch, const unsigned char** data) {
+    if (reader->map) {
+        size_t n = reader->map_size - reader->pos;
+        if (n > size) n = size;
+        *data = reader->map + reader->pos;
+        reader->pos += n;
+        return n;
+    }
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = read(reader->fd, scratch + total, size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            reader->error = 1;
+            break;
+        }
+        if (n == 0) break;
+        total += (size_t)n;
+    }
+    *data = scratch;
+    return total;
+}
+
+void file_reader_close(FileReader* reader) {
+    if (reader->map) {
+        munmap((void*)reader->map, reader->map_size);
+        reader->map = NULL;
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+}
+
+static int write_all(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        data += n;
+        size -= (size_t)n;
+    }
+    return 1;
+}
+
+int file_writer_open(FileWriter* writer, const char* filename) {
+    writer->used = 0;
+    writer->error = 0;
+    writer->buffer = NULL;
+
+    writer->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) return 0;
+
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, FILEIO_ALIGNMENT, FILEIO_BUFFER_SIZE) != 0) {
+        close(writer->fd);
+        writer->fd = -1;
+        return 0;
+    }
+    writer->buffer = (unsigned char*)buffer;
+    return 1;
+}
+
+int file_writer_write(FileWriter* writer, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    if (writer->error) return 0;
+
+    if (writer->used + size > FILEIO_BUFFER_SIZE) {
+        if (!write_all(writer->fd, writer->buffer, writer->used)) writer->error = 1;
+        writer->used = 0;
+    }
+
+    // Fragment większy niż bufor trafia do pliku bez kopiowania
+    if (size >= FILEIO_BUFFER_SIZE) {
+        if (!write_all(writer->fd, p, size)) writer->error = 1;
+        return !writer->error;
+    }
+
+    memcpy(writer->buffer + writer->used, p, size);
+    writer->used += size;
+    return !writer->error;
+}
+
+int file_writer_close(FileWriter* writer) {
+    if (writer->fd < 0) return 0;
+    if (!writer->error && writer->used > 0 && !write_all(writer->fd, writer->buffer, writer->used)) {
+        writer->error = 1;
+    }
+    if (close(writer->fd) != 0) writer->error = 1;
+    writer->fd = -1;
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return !writer->error;
+}
@@ -0,0 +1,38 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <stddef.h>
+
+#define FILEIO_BUFFER_SIZE (1 << 20)    // Bufor zapisu (wyrównany do strony)
+#define FILEIO_ALIGNMENT 4096
+
+// Odczyt pliku: cały plik mapowany do pamięci (mmap z podpowiedzią odczytu sekwencyjnego),
+// a gdy mmap jest niedostępny (potok, pusty plik, błąd) - duże porcje czytane funkcją read()
+typedef struct {
+    int fd;
+    const unsigned char* map;     // Zmapowany plik albo NULL
+    size_t map_size;
+    size_t pos;                   // Pozycja odczytu w zmapowanym pliku
+    int error;
+} FileReader;
+
+// Zapis pliku przez duży wyrównany bufor i funkcję write(); duże fragmenty zapisywane są bezpośrednio
+typedef struct {
+    int fd;
+    unsigned char* buffer;
+    size_t used;
+    int error;
+} FileWriter;
+
+// Funkcje odczytu
+int file_reader_open(FileReader* reader, const char* filename);
+int file_reader_mapped(const FileReader* reader);
+size_t file_reader_read(FileReader* reader, size_t size, unsigned char* scratch, const unsigned char** data);
+void file_reader_close(FileReader* reader);
+
+// Funkcje zapisu
+int file_writer_open(FileWriter* writer, const char* filename);
+int file_writer_write(FileWriter* writer, const void* data, size_t size);
+int file_writer_close(FileWriter* writer);
+
+#endif // FILEIO_H
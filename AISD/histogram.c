@@ -0,0 +1,65 @@
+#include "histogram.h"
+#include <string.h>
+
+#define HISTOGRAM_TABLES 4
+#define HISTOGRAM_SMALL 64
+#define HISTOGRAM_MAX_CHUNK ((size_t)1 << 30)   // Liczniki 32-bitowe nie przepełnią się w jednej porcji
+
+// Kolejne bajty trafiają do różnych podhistogramów, więc powtarzające się symbole
+// nie czekają na zapis poprzedniej inkrementacji tego samego licznika
+static void count_chunk(const unsigned char* p, size_t size, uint64_t counts[HISTOGRAM_SYMBOLS]) {
+    uint32_t tables[HISTOGRAM_TABLES][HISTOGRAM_SYMBOLS];
+    memset(tables, 0, sizeof(tables));
+
+    const unsigned char* end = p + size;
+    while (end - p >= 16) {
+        uint64_t a, b;
+        memcpy(&a, p, 8);
+        memcpy(&b, p + 8, 8);
+        p += 16;
+
+        tables[0][a & 0xFF]++;
+        tables[1][(a >> 8) & 0xFF]++;
+        tables[2][(a >> 16) & 0xFF]++;
+        tables[3][(a >> 24) & 0xFF]++;
+        tables[0][(a >> 32) & 0xFF]++;
+        tables[1][(a >> 40) & 0xFF]++;
+        tables[2][(a >> 48) & 0xFF]++;
+        tables[3][a >> 56]++;
+
+        tables[0][b & 0xFF]++;
+        tables[1][(b >> 8) & 0xFF]++;
+        tables[2][(b >> 16) & 0xFF]++;
+        tables[3][(b >> 24) & 0xFF]++;
+        tables[0][(b >> 32) & 0xFF]++;
+        tables[1][(b >> 40) & 0xFF]++;
+        tables[2][(b >> 48) & 0xFF]++;
+        tables[3][b >> 56]++;
+    }
+    while (p < end) {
+        tables[0][*p++]++;
+    }
+
+    for (int i = 0; i < HISTOGRAM_SYMBOLS; i++) {
+        counts[i] += (uint64_t)tables[0][i] + tables[1][i] + tables[2][i] + tables[3][i];
+    }
+}
+
+void histogram_count(const void* data, size_t size, uint64_t counts[HISTOGRAM_SYMBOLS]) {
+    const unsigned char* p = (const unsigned char*)data;
+
+    // Dla krótkich danych zerowanie podhistogramów kosztuje więcej niż samo liczenie
+    if (size < HISTOGRAM_SMALL) {
+        for (size_t i = 0; i < size; i++) {
+            counts[p[i]]++;
+        }
+        return;
+    }
+
+    while (size > 0) {
+        size_t n = size < HISTOGRAM_MAX_CHUNK ? size : HISTOGRAM_MAX_CHUNK;
+        count_chunk(p, n, counts);
+        p += n;
+        size -= n;
+    }
+}
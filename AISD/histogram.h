@@ -0,0 +1,12 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTOGRAM_SYMBOLS 256
+
+// Dolicza wystąpienia bajtów z `data` do `counts` (liczniki 64-bitowe, nie są zerowane)
+void histogram_count(const void* data, size_t size, uint64_t counts[HISTOGRAM_SYMBOLS]);
+
+#endif // HISTOGRAM_H
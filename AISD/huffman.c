@@ -1,324 +1,948 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "huffman.h"
+#include "bitstream.h"
+#include "threadpool.h"
+#include "fileio.h"
+#include "histogram.h"
+#include "typed_heap.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+
+// Kopiec węzłów: klucz to częstotliwość, wartość to numer węzła (liście 0..n-1, potem scalone)
+TYPED_HEAP_DEFINE(HuffmanHeap, uint64_t, uint16_t, TYPED_HEAP_LESS)
+
+// Do tylu symboli długości liczy kopiec: przy małym alfabecie stały koszt sortowania
+// pozycyjnego (256 kubełków na przebieg) przewyższa koszt n log n operacji na kopcu
+#define HUFFMAN_HEAP_MAX_SYMBOLS 40
 
-HuffmanNode* huffman_create_node(unsigned char ch, int freq) {
-    HuffmanNode* node = (HuffmanNode*)malloc(sizeof(HuffmanNode));
-    if (!node) return NULL;
+// Długości kodów z kopca: scala dwa najlżejsze węzły, zapamiętując rodzica każdego węzła.
+// Rodzic ma zawsze większy numer niż dziecko, więc głębokości liczy jeden przebieg w dół.
+static int heap_code_lengths(const uint64_t frequencies[], HuffmanCode codes[]) {
+    HuffmanHeap_item items[MAX_CHARS];
+    uint16_t parent[2 * MAX_CHARS - 1];
+    uint8_t symbols[MAX_CHARS];
+    HuffmanHeap heap;
+    HuffmanHeap_init_fixed(&heap, items, MAX_CHARS);
+
+    int n = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        codes[i].length = 0;
+        if (frequencies[i] > 0) {
+            items[n].key = frequencies[i];
+            items[n].value = (uint16_t)n;
+            symbols[n] = (uint8_t)i;
+            n++;
+        }
+    }
+    if (n < 2) return n;
+    heap.size = (size_t)n;
+    HuffmanHeap_heapify(&heap);
+
+    uint64_t left_freq, right_freq;
+    uint16_t left, right;
+    uint16_t next = (uint16_t)n;
+    while (HuffmanHeap_size(&heap) > 1) {
+        HuffmanHeap_pop(&heap, &left_freq, &left);
+        HuffmanHeap_pop(&heap, &right_freq, &right);
+        parent[left] = next;
+        parent[right] = next;
+        HuffmanHeap_push(&heap, left_freq + right_freq, next);
+        next++;
+    }
 
-    node->character = ch;
-    node->frequency = freq;
-    node->left = NULL;
-    node->right = NULL;
-    return node;
+    uint8_t depth[2 * MAX_CHARS - 1];
+    depth[next - 1] = 0;
+    for (int node = next - 2; node >= 0; node--) {
+        depth[node] = (uint8_t)(depth[parent[node]] + 1);
+    }
+    for (int i = 0; i < n; i++) {
+        codes[symbols[i]].length = depth[i];
+    }
+    return n;
 }
 
-void huffman_destroy_tree(HuffmanNode* root) {
-    if (!root) return;
-    huffman_destroy_tree(root->left);
-    huffman_destroy_tree(root->right);
-    free(root);
+// Sortuje symbole o niezerowej częstotliwości rosnąco (radix sort po bajtach częstotliwości,
+// stabilny, więc równe częstotliwości zostają w kolejności symboli); zwraca liczbę symboli.
+// Częstotliwości muszą być mniejsze niż 2^56 (symbol zajmuje najmłodszy bajt klucza).
+static int sort_symbols(const uint64_t frequencies[], uint64_t weights[], uint8_t symbols[]) {
+    uint64_t keys[MAX_CHARS], tmp[MAX_CHARS];
+    uint64_t max_key = 0;
+    int n = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (frequencies[i] > 0) {
+            keys[n] = (frequencies[i] << 8) | (uint64_t)i;
+            if (keys[n] > max_key) max_key = keys[n];
+            n++;
+        }
+    }
+
+    for (int shift = 8; shift < 64 && (max_key >> shift) != 0; shift += 8) {
+        int count[256] = {0};
+        for (int i = 0; i < n; i++) count[(keys[i] >> shift) & 0xFF]++;
+        if (n == 0 || count[(keys[0] >> shift) & 0xFF] == n) continue;   // Wszystkie cyfry równe
+
+        int pos = 0;
+        for (int d = 0; d < 256; d++) {
+            int c = count[d];
+            count[d] = pos;
+            pos += c;
+        }
+        for (int i = 0; i < n; i++) tmp[count[(keys[i] >> shift) & 0xFF]++] = keys[i];
+        memcpy(keys, tmp, (size_t)n * sizeof(uint64_t));
+    }
+
+    for (int i = 0; i < n; i++) {
+        weights[i] = keys[i] >> 8;
+        symbols[i] = (uint8_t)keys[i];
+    }
+    return n;
 }
 
-HuffmanNode* huffman_build_tree(int frequencies[]) {
-    PriorityQueue* pq = pq_create(MAX_CHARS);
-    if (!pq) return NULL;
+// Długości kodów Huffmana: dla małego alfabetu z kopca, w przeciwnym razie algorytmem
+// Moffata-Katajainena działającym w miejscu na posortowanych wagach (scalanie dwóch kolejek:
+// liści i węzłów wewnętrznych, oba rosnące). Ustawia codes[].length i zwraca liczbę symboli.
+int huffman_code_lengths(const uint64_t frequencies[], HuffmanCode codes[]) {
+    int symbol_count = 0;
+    for (int i = 0; i < MAX_CHARS; i++) symbol_count += frequencies[i] > 0;
+    if (symbol_count <= HUFFMAN_HEAP_MAX_SYMBOLS) return heap_code_lengths(frequencies, codes);
+
+    uint64_t a[MAX_CHARS];
+    uint8_t symbols[MAX_CHARS];
+    int n = sort_symbols(frequencies, a, symbols);
 
     for (int i = 0; i < MAX_CHARS; i++) {
-        if (frequencies[i] > 0) {
-            HuffmanNode* node = huffman_create_node((unsigned char)i, frequencies[i]);
-            if (node) {
-                pq_add(pq, node, frequencies[i]);
-            }
+        codes[i].length = 0;
+    }
+    if (n < 2) return n;
+
+    // Faza 1: wagi węzłów wewnętrznych; a[i] dla scalonych węzłów staje się indeksem rodzica
+    a[0] += a[1];
+    int root = 0, leaf = 2;
+    for (int next = 1; next < n - 1; next++) {
+        if (leaf >= n || a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = (uint64_t)next;
+        } else {
+            a[next] = a[leaf++];
+        }
+
+        if (leaf >= n || (root < next && a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = (uint64_t)next;
+        } else {
+            a[next] += a[leaf++];
         }
     }
 
-    while (pq_size(pq) > 1) {
-        HuffmanNode* left = (HuffmanNode*)pq_remove(pq);
-        HuffmanNode* right = (HuffmanNode*)pq_remove(pq);
+    // Faza 2: głębokości węzłów wewnętrznych
+    a[n - 2] = 0;
+    for (int next = n - 3; next >= 0; next--) {
+        a[next] = a[a[next]] + 1;
+    }
 
-        HuffmanNode* merged = huffman_create_node(0, left->frequency + right->frequency);
-        if (!merged) {
-            huffman_destroy_tree(left);
-            huffman_destroy_tree(right);
-            pq_destroy(pq);
-            return NULL;
+    // Faza 3: głębokości liści
+    int available = 1, used = 0, depth = 0, next = n - 1;
+    root = n - 2;
+    while (available > 0) {
+        while (root >= 0 && a[root] == (uint64_t)depth) {
+            used++;
+            root--;
         }
+        while (available > used) {
+            a[next--] = (uint64_t)depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        codes[symbols[i]].length = (uint8_t)a[i];
+    }
+    return n;
+}
+
+void huffman_assign_canonical_codes(HuffmanCode codes[]) {
+    int length_count[HUFFMAN_MAX_DECODE_LEN + 1] = {0};
+    for (int i = 0; i < MAX_CHARS; i++) {
+        length_count[codes[i].length]++;
+    }
+    length_count[0] = 0;
 
-        merged->left = left;
-        merged->right = right;
-        pq_add(pq, merged, merged->frequency);
+    uint64_t next_code[HUFFMAN_MAX_DECODE_LEN + 1];
+    uint64_t code = 0;
+    for (int len = 1; len <= HUFFMAN_MAX_DECODE_LEN; len++) {
+        code = (code + (uint64_t)length_count[len - 1]) << 1;
+        next_code[len] = code;
     }
 
-    HuffmanNode* root = (HuffmanNode*)pq_remove(pq);
-    pq_destroy(pq);
-    return root;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        int len = codes[i].length;
+        codes[i].bits = len > 0 ? next_code[len]++ : 0;
+    }
 }
 
-void huffman_build_codes(HuffmanNode* root, char codes[][MAX_CODE_LEN], int code_lengths[], char* current_code, int depth) {
-    if (!root) return;
+typedef struct {
+    uint64_t weight;
+    int symbol;           // Symbol liścia albo -1 dla paczki
+} PackageItem;
+
+// Algorytm package-merge: optymalne długości kodów nieprzekraczające max_len
+static int package_merge(const uint64_t frequencies[], HuffmanCode codes[], int max_len) {
+    // Liście rosnąco po wadze, równe wagi w kolejności symboli
+    uint64_t weights[MAX_CHARS];
+    uint8_t symbols[MAX_CHARS];
+    PackageItem leaves[MAX_CHARS];
+    int n = sort_symbols(frequencies, weights, symbols);
+    for (int i = 0; i < n; i++) {
+        leaves[i].weight = weights[i];
+        leaves[i].symbol = symbols[i];
+    }
 
-    if (!root->left && !root->right) {
-        if (depth < MAX_CODE_LEN - 1) {
-            current_code[depth] = '\0';
-            strcpy(codes[root->character], current_code);
-            code_lengths[root->character] = depth;
+    size_t level_capacity = 2 * (size_t)n;
+    PackageItem* levels = (PackageItem*)malloc((size_t)max_len * level_capacity * sizeof(PackageItem));
+    int sizes[HUFFMAN_MAX_CODE_LEN];
+    if (!levels) return 0;
+
+    // Poziom max_len - 1 odpowiada najgłębszym bitom kodu
+    memcpy(levels + (size_t)(max_len - 1) * level_capacity, leaves, (size_t)n * sizeof(PackageItem));
+    sizes[max_len - 1] = n;
+
+    for (int d = max_len - 2; d >= 0; d--) {
+        const PackageItem* prev = levels + (size_t)(d + 1) * level_capacity;
+        PackageItem* cur = levels + (size_t)d * level_capacity;
+        int packages = sizes[d + 1] / 2;
+        int li = 0, pi = 0, count = 0;
+
+        while (li < n || pi < packages) {
+            uint64_t package_weight = pi < packages ? prev[2 * pi].weight + prev[2 * pi + 1].weight : 0;
+            if (li < n && (pi >= packages || leaves[li].weight <= package_weight)) {
+                cur[count++] = leaves[li++];
+            } else {
+                cur[count].weight = package_weight;
+                cur[count].symbol = -1;
+                count++;
+                pi++;
+            }
         }
-        return;
+        sizes[d] = count;
     }
 
-    if (depth < MAX_CODE_LEN - 1) {
-        current_code[depth] = '0';
-        huffman_build_codes(root->left, codes, code_lengths, current_code, depth + 1);
+    for (int i = 0; i < MAX_CHARS; i++) {
+        codes[i].length = 0;
     }
 
-    if (depth < MAX_CODE_LEN - 1) {
-        current_code[depth] = '1';
-        huffman_build_codes(root->right, codes, code_lengths, current_code, depth + 1);
+    // Każde wystąpienie liścia wśród wybranych elementów wydłuża jego kod o 1 bit
+    int take = 2 * n - 2;
+    for (int d = 0; d < max_len && take > 0; d++) {
+        const PackageItem* cur = levels + (size_t)d * level_capacity;
+        int packages_taken = 0;
+        for (int k = 0; k < take && k < sizes[d]; k++) {
+            if (cur[k].symbol >= 0) {
+                codes[cur[k].symbol].length++;
+            } else {
+                packages_taken++;
+            }
+        }
+        take = 2 * packages_taken;
     }
+
+    free(levels);
+    return 1;
 }
 
-void huffman_count_frequencies(const char* filename, int frequencies[]) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        for (int i = 0; i < MAX_CHARS; i++) {
-            frequencies[i] = 0;
-        }
-        return;
+int huffman_limit_code_lengths(const uint64_t frequencies[], HuffmanCode codes[], int max_len) {
+    int symbols = 0, longest = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (frequencies[i] > 0) symbols++;
+        if (codes[i].length > longest) longest = codes[i].length;
+    }
+
+    if (max_len > HUFFMAN_MAX_CODE_LEN) max_len = HUFFMAN_MAX_CODE_LEN;
+    while (max_len < HUFFMAN_MAX_CODE_LEN && (1 << max_len) < symbols) max_len++;
+
+    if (symbols < 2 || longest <= max_len) return 1;
+    return package_merge(frequencies, codes, max_len);
+}
+
+void huffman_default_options(HuffmanOptions* options) {
+    options->max_code_length = HUFFMAN_DEFAULT_MAX_CODE_LEN;
+    options->block_size = HUFFMAN_DEFAULT_BLOCK_SIZE;
+    options->threads = 0;
+    options->context_tables = 0;
+    options->link_mb_per_s = HUFFMAN_DEFAULT_LINK_MB_S;
+    options->context_ns_per_byte = HUFFMAN_DEFAULT_CONTEXT_NS_PER_BYTE;
+    options->cluster_ns_per_op = HUFFMAN_DEFAULT_CLUSTER_NS_PER_OP;
+    options->adaptive_interval = 0;
+    options->quiet = 0;
+    options->stats = NULL;
+    options->dictionary = NULL;
+}
+
+void huffman_stats_reset(HuffmanStats* stats) {
+    memset(stats, 0, sizeof(HuffmanStats));
+}
+
+void huffman_stats_add(HuffmanStats* dst, const HuffmanStats* src) {
+    dst->count_seconds += src->count_seconds;
+    dst->tree_seconds += src->tree_seconds;
+    dst->codes_seconds += src->codes_seconds;
+    dst->coding_seconds += src->coding_seconds;
+    dst->io_seconds += src->io_seconds;
+    dst->total_seconds += src->total_seconds;
+    dst->bytes_in += src->bytes_in;
+    dst->bytes_out += src->bytes_out;
+    dst->blocks += src->blocks;
+    dst->symbols += src->symbols;
+    dst->code_bits += src->code_bits;
+    dst->entropy_bits += src->entropy_bits;
+    if (src->max_code_length > dst->max_code_length) dst->max_code_length = src->max_code_length;
+}
+
+// Czas procesora bieżącego wątku: fazy liczone w kilku wątkach nie zawyżają się, gdy wątków
+// jest więcej niż rdzeni (czekanie na rdzeń się nie liczy)
+double huffman_stats_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Czas rzeczywisty, tylko dla total_seconds
+double huffman_stats_wall_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void print_phase(const char* name, double seconds, const HuffmanStats* stats) {
+    // Wyrównanie liczone w znakach, nie w bajtach UTF-8
+    int width = 0;
+    for (const char* p = name; *p; p++) {
+        if ((*p & 0xC0) != 0x80) width++;
     }
+    double share = stats->total_seconds > 0 ? 100.0 * seconds / stats->total_seconds : 0;
+    printf("  %s%*s %10.3f ms  %6.1f%%\n", name, width < 24 ? 24 - width : 0, "", seconds * 1e3, share);
+}
+
+void huffman_print_stats(const HuffmanStats* stats) {
+    printf("Statystyki:\n");
+    print_phase("histogram", stats->count_seconds, stats);
+    print_phase("długości kodów", stats->tree_seconds, stats);
+    print_phase("kody kanoniczne", stats->codes_seconds, stats);
+    print_phase("(de)kodowanie", stats->coding_seconds, stats);
+    print_phase("odczyt i zapis", stats->io_seconds, stats);
+    print_phase("razem (czas rzeczywisty)", stats->total_seconds, stats);
+
+    // Przepustowość liczona względem danych nieskompresowanych w obu kierunkach
+    double mb_s = stats->total_seconds > 0 ? (double)stats->symbols / stats->total_seconds / 1e6 : 0;
+    printf("  wejście: %llu B, wyjście: %llu B, bloki: %llu, %.1f MB/s\n", (unsigned long long)stats->bytes_in,
+           (unsigned long long)stats->bytes_out, (unsigned long long)stats->blocks, mb_s);
+    if (stats->symbols > 0) {
+        printf("  średnia długość kodu: %.3f bit/symbol", (double)stats->code_bits / (double)stats->symbols);
+        if (stats->entropy_bits > 0) printf(", entropia: %.3f bit/symbol", stats->entropy_bits / (double)stats->symbols);
+        printf("\n");
+    }
+    if (stats->max_code_length > 0) printf("  najdłuższy kod: %d bitów\n", stats->max_code_length);
+}
 
+void huffman_count_frequencies(const char* filename, uint64_t frequencies[]) {
     for (int i = 0; i < MAX_CHARS; i++) {
         frequencies[i] = 0;
     }
 
-    int ch;
-    while ((ch = fgetc(file)) != EOF) {
-        frequencies[ch]++;
+    FileReader reader;
+    if (!file_reader_open(&reader, filename)) return;
+
+    // Zmapowany plik liczony jest w całości jednym przebiegiem
+    unsigned char buf[HUFFMAN_IO_CHUNK];
+    const unsigned char* data;
+    size_t chunk = file_reader_mapped(&reader) ? SIZE_MAX : sizeof(buf);
+    size_t n;
+    while ((n = file_reader_read(&reader, chunk, buf, &data)) > 0) {
+        histogram_count(data, n, frequencies);
     }
 
-    fclose(file);
+    file_reader_close(&reader);
 }
 
-int huffman_compress(const char* input_file, const char* output_file) {
-    int frequencies[MAX_CHARS];
-    huffman_count_frequencies(input_file, frequencies);
+typedef struct {
+    uint64_t code;
+    int length;
+    unsigned char symbol;
+} DecodeSymbol;
+
+static uint64_t low_bits(uint64_t value, int bits) {
+    return bits >= 64 ? value : value & ((UINT64_C(1) << bits) - 1);
+}
+
+static int compare_decode_symbols(const void* a, const void* b) {
+    const DecodeSymbol* x = (const DecodeSymbol*)a;
+    const DecodeSymbol* y = (const DecodeSymbol*)b;
+    uint64_t cx = x->code << (64 - x->length);
+    uint64_t cy = y->code << (64 - y->length);
+    if (cx != cy) return cx < cy ? -1 : 1;
+    return x->length - y->length;
+}
+
+// Sortuje symbole po długości kodu (stabilnie, więc w obrębie długości po symbolu) i sprawdza,
+// czy kolejność zgadza się z porządkiem kodów wyrównanych do lewej; zwraca 0, gdy kod nie jest kanoniczny
+static int sort_canonical_symbols(DecodeSymbol syms[], size_t n) {
+    size_t start[HUFFMAN_MAX_DECODE_LEN + 2] = {0};
+    for (size_t i = 0; i < n; i++) start[syms[i].length + 1]++;
+    for (int len = 1; len <= HUFFMAN_MAX_DECODE_LEN + 1; len++) start[len] += start[len - 1];
+
+    DecodeSymbol sorted[MAX_CHARS];
+    for (size_t i = 0; i < n; i++) sorted[start[syms[i].length]++] = syms[i];
+    for (size_t i = 1; i < n; i++) {
+        if (compare_decode_symbols(&sorted[i - 1], &sorted[i]) >= 0) return 0;
+    }
+    memcpy(syms, sorted, n * sizeof(DecodeSymbol));
+    return 1;
+}
+
+static int reserve_entries(HuffmanDecodeTable* table, size_t n, size_t* start) {
+    if (table->count + n > table->capacity) {
+        size_t new_capacity = table->capacity ? table->capacity : 1024;
+        while (new_capacity < table->count + n) new_capacity *= 2;
+        HuffmanDecodeEntry* entries = (HuffmanDecodeEntry*)realloc(table->entries, new_capacity * sizeof(HuffmanDecodeEntry));
+        if (!entries) return 0;
+        table->entries = entries;
+        table->capacity = new_capacity;
+    }
+    memset(table->entries + table->count, 0, n * sizeof(HuffmanDecodeEntry));
+    *start = table->count;
+    table->count += n;
+    return 1;
+}
+
+// Buduje jeden poziom tablicy dla kodów o wspólnym prefiksie długości `consumed`
+static int build_level(HuffmanDecodeTable* table, const DecodeSymbol* syms, size_t n, int consumed, size_t* out_start, int* out_bits) {
+    int max_len = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (syms[i].length > max_len) max_len = syms[i].length;
+    }
+
+    int bits = max_len - consumed;
+    if (bits > HUFFMAN_TABLE_BITS) bits = HUFFMAN_TABLE_BITS;
+
+    size_t start;
+    if (!reserve_entries(table, (size_t)1 << bits, &start)) return 0;
+
+    size_t i = 0;
+    while (i < n) {
+        int remaining = syms[i].length - consumed;
+        uint64_t suffix = low_bits(syms[i].code, remaining);
+
+        if (remaining <= bits) {
+            size_t first = (size_t)suffix << (bits - remaining);
+            size_t span = (size_t)1 << (bits - remaining);
+            for (size_t k = first; k < first + span; k++) {
+                HuffmanDecodeEntry* entry = &table->entries[start + k];
+                if (entry->kind != HUFFMAN_ENTRY_INVALID) return 0;
+                entry->value = syms[i].symbol;
+                entry->bits = (uint8_t)remaining;
+                entry->kind = HUFFMAN_ENTRY_LEAF;
+            }
+            i++;
+            continue;
+        }
+
+        size_t index = (size_t)(suffix >> (remaining - bits));
+        size_t j = i + 1;
+        while (j < n) {
+            int rem_j = syms[j].length - consumed;
+            if (rem_j <= bits || (size_t)(low_bits(syms[j].code, rem_j) >> (rem_j - bits)) != index) break;
+            j++;
+        }
+
+        if (table->entries[start + index].kind != HUFFMAN_ENTRY_INVALID) return 0;
+
+        size_t sub_start;
+        int sub_bits;
+        if (!build_level(table, syms + i, j - i, consumed + bits, &sub_start, &sub_bits)) return 0;
+
+        HuffmanDecodeEntry* link = &table->entries[start + index];
+        link->value = (uint32_t)sub_start;
+        link->bits = (uint8_t)sub_bits;
+        link->kind = HUFFMAN_ENTRY_LINK;
+        i = j;
+    }
 
-    int total_chars = 0;
+    *out_start = start;
+    *out_bits = bits;
+    return 1;
+}
+
+void huffman_decode_table_init(HuffmanDecodeTable* table) {
+    table->entries = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->root_bits = 0;
+    table->single_level = 0;
+}
+
+int huffman_decode_table_build(HuffmanDecodeTable* table, const HuffmanCode codes[]) {
+    table->count = 0;
+    table->root_bits = 0;
+    table->single_level = 0;
+
+    DecodeSymbol syms[MAX_CHARS];
+    size_t n = 0;
     for (int i = 0; i < MAX_CHARS; i++) {
-        total_chars += frequencies[i];
+        if (codes[i].length == 0) continue;
+        if (codes[i].length > HUFFMAN_MAX_DECODE_LEN) return 0;
+        syms[n].code = low_bits(codes[i].bits, codes[i].length);
+        syms[n].length = codes[i].length;
+        syms[n].symbol = (unsigned char)i;
+        n++;
     }
-    if (total_chars == 0) {
-        printf("Błąd: Plik wejściowy jest pusty!\n");
+    if (n == 0) return 1;
+
+    // Kody kanoniczne są już uporządkowane po (długość, symbol): wystarczy sortowanie przez
+    // zliczanie po długości; inne kody prefiksowe sortowane są porównaniami
+    if (!sort_canonical_symbols(syms, n)) qsort(syms, n, sizeof(DecodeSymbol), compare_decode_symbols);
+
+    size_t root_start;
+    if (!build_level(table, syms, n, 0, &root_start, &table->root_bits)) {
+        table->count = 0;
         return 0;
     }
 
-    HuffmanNode* root = huffman_build_tree(frequencies);
-    if (!root) {
-        printf("Błąd: Nie udało się zbudować drzewa Huffmana!\n");
-        return 0;
+    table->single_level = table->count == ((size_t)1 << table->root_bits);
+    for (size_t i = 0; i < table->count && table->single_level; i++) {
+        if (table->entries[i].kind != HUFFMAN_ENTRY_LEAF) table->single_level = 0;
     }
+    return 1;
+}
 
-    char codes[MAX_CHARS][MAX_CODE_LEN];
-    int code_lengths[MAX_CHARS];
-    char current_code[MAX_CODE_LEN];
-    for (int i = 0; i < MAX_CHARS; i++) {
-        codes[i][0] = '\0';
-        code_lengths[i] = 0;
+void huffman_decode_table_free(HuffmanDecodeTable* table) {
+    free(table->entries);
+    table->entries = NULL;
+    table->count = 0;
+    table->capacity = 0;
+    table->root_bits = 0;
+    table->single_level = 0;
+}
+
+
+typedef struct {
+    uint64_t offset;      // Położenie nagłówka bloku w pliku
+    uint32_t raw_size;
+} BlockIndexEntry;
+
+typedef struct {
+    const HuffmanOptions* options;
+    const unsigned char** inputs; // Wskazują na zmapowany plik albo na bufory scratch
+    unsigned char** scratch;      // Bufory odczytu (tylko gdy plik nie jest zmapowany)
+    size_t* input_sizes;
+    unsigned char** outputs;
+    size_t* output_sizes;
+    HuffmanStats* stats;          // Osobne statystyki każdego miejsca (NULL = bez pomiarów)
+} EncodeBatch;
+
+static void encode_batch_task(void* context, size_t index) {
+    EncodeBatch* batch = (EncodeBatch*)context;
+    batch->output_sizes[index] = huffman_encode_block(batch->inputs[index], batch->input_sizes[index],
+                                                      batch->options, batch->outputs[index],
+                                                      batch->stats ? &batch->stats[index] : NULL);
+}
+
+// Wczytuje do `slots` kolejnych bloków; zwraca liczbę wczytanych bloków
+static size_t read_batch(FileReader* input, EncodeBatch* batch, size_t slots, size_t block_size, int* eof) {
+    size_t count = 0;
+    while (count < slots && !*eof) {
+        size_t n = file_reader_read(input, block_size, batch->scratch[count], &batch->inputs[count]);
+        if (n < block_size) *eof = 1;
+        if (n == 0) break;
+        batch->input_sizes[count++] = n;
+    }
+    return count;
+}
+
+static int write_index(FileWriter* output, const BlockIndexEntry* index, size_t count, uint64_t index_offset, uint64_t original_size) {
+    unsigned char buf[HUFFMAN_TRAILER_SIZE];
+    bitstream_store_le32(buf, (uint32_t)count);
+    int ok = file_writer_write(output, buf, 4);
+
+    for (size_t i = 0; i < count && ok; i++) {
+        bitstream_store_le64(buf, index[i].offset);
+        bitstream_store_le32(buf + 8, index[i].raw_size);
+        ok = file_writer_write(output, buf, HUFFMAN_INDEX_ENTRY_SIZE);
+    }
+
+    bitstream_store_le64(buf, index_offset);
+    bitstream_store_le64(buf + 8, original_size);
+    memcpy(buf + 16, HUFFMAN_TRAILER_MAGIC, 4);
+    return ok && file_writer_write(output, buf, HUFFMAN_TRAILER_SIZE);
+}
+
+int huffman_compress(const char* input_file, const char* output_file) {
+    HuffmanOptions options;
+    huffman_default_options(&options);
+    return huffman_compress_with_options(input_file, output_file, &options);
+}
+
+int huffman_compress_with_options(const char* input_file, const char* output_file, const HuffmanOptions* options) {
+    if (options->dictionary) return huffman_compress_message_file(input_file, output_file, options);
+    if (options->max_code_length < 1 || options->max_code_length > HUFFMAN_MAX_CODE_LEN) {
+        printf("Błąd: Maksymalna długość kodu musi być z zakresu 1-%d!\n", HUFFMAN_MAX_CODE_LEN);
+        return 0;
+    }
+    if (options->block_size < HUFFMAN_MIN_BLOCK_SIZE || options->block_size > HUFFMAN_MAX_BLOCK_SIZE) {
+        printf("Błąd: Rozmiar bloku musi być z zakresu %d-%d bajtów!\n", HUFFMAN_MIN_BLOCK_SIZE, HUFFMAN_MAX_BLOCK_SIZE);
+        return 0;
+    }
+    if (options->context_tables != 0 && (options->context_tables < 2 || options->context_tables > HUFFMAN_MAX_CONTEXTS)) {
+        printf("Błąd: Liczba tablic kontekstowych musi wynosić 0 albo 2-%d!\n", HUFFMAN_MAX_CONTEXTS);
+        return 0;
+    }
+    if (options->adaptive_interval != 0 &&
+        (options->adaptive_interval < HUFFMAN_MIN_ADAPTIVE_INTERVAL || options->adaptive_interval > HUFFMAN_MAX_BLOCK_SIZE)) {
+        printf("Błąd: Odstęp przebudowy kodów musi wynosić 0 albo %d-%d bajtów!\n",
+               HUFFMAN_MIN_ADAPTIVE_INTERVAL, HUFFMAN_MAX_BLOCK_SIZE);
+        return 0;
     }
-    huffman_build_codes(root, codes, code_lengths, current_code, 0);
 
-    FILE* input = fopen(input_file, "rb");
-    FILE* output = fopen(output_file, "w");
-    if (!input || !output) {
+    double start = huffman_stats_wall_clock(), io_seconds = 0;
+    FileReader input;
+    if (!file_reader_open(&input, input_file)) {
         printf("Błąd: Nie udało się otworzyć plików!\n");
-        huffman_destroy_tree(root);
-        if (input) fclose(input);
-        if (output) fclose(output);
         return 0;
     }
 
-    fprintf(output, "SŁOWNIK:\n");
-    for (int i = 0; i < MAX_CHARS; i++) {
-        if (frequencies[i] > 0) {
-            if (i >= 32 && i <= 126) {
-                fprintf(output, "%c: %d - %s\n", i, frequencies[i], codes[i]);
-            } else if (i == ' ') {
-                fprintf(output, "SPACJA: %d - %s\n", frequencies[i], codes[i]);
-            } else if (i == '\n') {
-                fprintf(output, "ENTER: %d - %s\n", frequencies[i], codes[i]);
-            } else if (i == '\t') {
-                fprintf(output, "TAB: %d - %s\n", frequencies[i], codes[i]);
-            } else {
-                fprintf(output, "\\x%02X: %d - %s\n", i, frequencies[i], codes[i]);
-            }
+    ThreadPool* pool = threadpool_create(options->threads);
+    size_t slots = (size_t)threadpool_size(pool) * 2;
+    size_t block_size = options->block_size;
+    size_t bound = huffman_block_bound(block_size, options);
+
+    EncodeBatch batch;
+    batch.options = options;
+    batch.inputs = (const unsigned char**)calloc(slots, sizeof(const unsigned char*));
+    batch.scratch = (unsigned char**)calloc(slots, sizeof(unsigned char*));
+    batch.outputs = (unsigned char**)calloc(slots, sizeof(unsigned char*));
+    batch.input_sizes = (size_t*)calloc(slots, sizeof(size_t));
+    batch.output_sizes = (size_t*)calloc(slots, sizeof(size_t));
+    batch.stats = options->stats ? (HuffmanStats*)calloc(slots, sizeof(HuffmanStats)) : NULL;
+
+    // Zmapowany plik kodowany jest bezpośrednio z mapy, bez kopiowania do buforów
+    int ok = pool && batch.inputs && batch.scratch && batch.outputs && batch.input_sizes && batch.output_sizes &&
+             (batch.stats || !options->stats);
+    for (size_t i = 0; ok && i < slots; i++) {
+        if (!file_reader_mapped(&input)) {
+            batch.scratch[i] = (unsigned char*)malloc(block_size);
+            if (!batch.scratch[i]) ok = 0;
+        }
+        batch.outputs[i] = (unsigned char*)malloc(bound);
+        if (!batch.outputs[i]) ok = 0;
+    }
+
+    FileWriter output;
+    int output_open = 0;
+    BlockIndexEntry* index = NULL;
+    size_t index_count = 0, index_capacity = 0;
+    uint64_t offset = HUFFMAN_FILE_HEADER_SIZE;
+    uint64_t original_size = 0;
+    int eof = 0;
+
+    double io_start = huffman_stats_clock();
+    size_t count = ok ? read_batch(&input, &batch, slots, block_size, &eof) : 0;
+    io_seconds += huffman_stats_clock() - io_start;
+    if (ok && count == 0) {
+        printf(input.error ? "Błąd: Nie udało się odczytać pliku wejściowego!\n" : "Błąd: Plik wejściowy jest pusty!\n");
+        ok = 0;
+    } else if (ok) {
+        output_open = file_writer_open(&output, output_file);
+        if (!output_open) {
+            printf("Błąd: Nie udało się otworzyć plików!\n");
+            ok = 0;
         }
+    } else {
+        printf("Błąd: Brak pamięci!\n");
     }
 
-    fprintf(output, "DANE:\n");
-    
-    int bit_buffer = 0;
-    int bit_count = 0;
-    int ch;
-    
-    while ((ch = fgetc(input)) != EOF) {
-        const char* code = codes[ch];
-        int len = code_lengths[ch];
-        
-        for (int i = 0; i < len; i++) {
-            bit_buffer = (bit_buffer << 1) | (code[i] - '0');
-            bit_count++;
-            
-            if (bit_count == 8) {
-                fprintf(output, "%c", (unsigned char)bit_buffer);
-                bit_buffer = 0;
-                bit_count = 0;
+    if (ok) {
+        unsigned char header[HUFFMAN_FILE_HEADER_SIZE];
+        huffman_write_file_header(header, (uint32_t)block_size);
+        ok = file_writer_write(&output, header, sizeof(header));
+    }
+
+    while (ok && count > 0) {
+        threadpool_for(pool, count, encode_batch_task, &batch);
+
+        io_start = huffman_stats_clock();
+        for (size_t i = 0; ok && i < count; i++) {
+            if (batch.output_sizes[i] == 0) {
+                printf("Błąd: Nie udało się zakodować bloku!\n");
+                ok = 0;
+                break;
+            }
+            if (index_count == index_capacity) {
+                size_t new_capacity = index_capacity ? index_capacity * 2 : 64;
+                BlockIndexEntry* new_index = (BlockIndexEntry*)realloc(index, new_capacity * sizeof(BlockIndexEntry));
+                if (!new_index) {
+                    ok = 0;
+                    break;
+                }
+                index = new_index;
+                index_capacity = new_capacity;
             }
+            index[index_count].offset = offset;
+            index[index_count].raw_size = (uint32_t)batch.input_sizes[i];
+            index_count++;
+
+            ok = file_writer_write(&output, batch.outputs[i], batch.output_sizes[i]);
+            offset += batch.output_sizes[i];
+            original_size += batch.input_sizes[i];
+        }
+
+        count = ok ? read_batch(&input, &batch, slots, block_size, &eof) : 0;
+        io_seconds += huffman_stats_clock() - io_start;
+    }
+    if (input.error) ok = 0;
+
+    if (ok) {
+        unsigned char end = HUFFMAN_BLOCK_END;
+        ok = file_writer_write(&output, &end, 1) &&
+             write_index(&output, index, index_count, offset + 1, original_size);
+    }
+
+    if (options->stats) {
+        huffman_stats_reset(options->stats);
+        for (size_t i = 0; batch.stats && i < slots; i++) {
+            huffman_stats_add(options->stats, &batch.stats[i]);
         }
+        options->stats->io_seconds = io_seconds;
+        options->stats->bytes_in = original_size;
+        options->stats->bytes_out = offset + 1 + 4 + index_count * HUFFMAN_INDEX_ENTRY_SIZE + HUFFMAN_TRAILER_SIZE;
     }
 
-    int padding = 0;
-    if (bit_count > 0) {
-        padding = 8 - bit_count;
-        bit_buffer <<= padding;
-        fprintf(output, "%c", (unsigned char)bit_buffer);
+    for (size_t i = 0; i < slots && batch.scratch && batch.outputs; i++) {
+        free(batch.scratch[i]);
+        free(batch.outputs[i]);
+    }
+    free(batch.inputs);
+    free(batch.scratch);
+    free(batch.outputs);
+    free(batch.input_sizes);
+    free(batch.output_sizes);
+    free(batch.stats);
+    free(index);
+    threadpool_destroy(pool);
+    file_reader_close(&input);
+
+    if (output_open && !file_writer_close(&output)) ok = 0;
+    if (!ok) {
+        if (output_open) printf("Błąd: Nie udało się zapisać pliku wyjściowego!\n");
+        return 0;
     }
-    fprintf(output, "\nPADDING: %d\n", padding);
+    if (options->stats) options->stats->total_seconds = huffman_stats_wall_clock() - start;
+
+    if (!options->quiet) printf("Kompresja zakończona pomyślnie!\n");
+    return 1;
+}
 
-    fclose(input);
-    fclose(output);
-    huffman_destroy_tree(root);
+typedef struct {
+    HuffmanBlockHeader* headers;
+    const unsigned char** payloads;   // Wskazują na zmapowany plik albo na bufory scratch
+    unsigned char** scratch;
+    size_t* scratch_capacities;
+    unsigned char** outputs;
+    HuffmanBlockDecoder* decoders;
+    int* results;
+} DecodeBatch;
+
+static void decode_batch_task(void* context, size_t index) {
+    DecodeBatch* batch = (DecodeBatch*)context;
+    batch->results[index] = huffman_decode_block(&batch->headers[index], batch->payloads[index],
+                                                 batch->outputs[index], &batch->decoders[index]);
+}
 
-    printf("Kompresja zakończona pomyślnie!\n");
+// Wczytuje dokładnie `size` bajtów do `buf`
+static int read_exact(FileReader* input, unsigned char* buf, size_t size) {
+    const unsigned char* data;
+    if (file_reader_read(input, size, buf, &data) != size) return 0;
+    if (data != buf) memcpy(buf, data, size);
     return 1;
 }
 
+// Wczytuje do `slots` kolejnych bloków; zwraca liczbę bloków albo -1 przy błędzie
+static long read_block_batch(FileReader* input, DecodeBatch* batch, size_t slots, uint32_t block_size, int* end) {
+    size_t count = 0;
+    while (count < slots && !*end) {
+        unsigned char block_header[HUFFMAN_BLOCK_HEADER_SIZE];
+        if (!read_exact(input, block_header, 1)) return -1;
+        if (block_header[0] == HUFFMAN_BLOCK_END) {
+            *end = 1;
+            break;
+        }
+
+        HuffmanBlockHeader* info = &batch->headers[count];
+        if (!read_exact(input, block_header + 1, HUFFMAN_BLOCK_HEADER_SIZE - 1) ||
+            !huffman_read_block_header(block_header, info) || info->raw_size > block_size) {
+            return -1;
+        }
+
+        // payload_size jest już ograniczony przez huffman_read_block_header (granica bloku dla raw_size)
+        if (!file_reader_mapped(input) && info->payload_size > batch->scratch_capacities[count]) {
+            unsigned char* payload = (unsigned char*)realloc(batch->scratch[count], info->payload_size);
+            if (!payload) return -1;
+            batch->scratch[count] = payload;
+            batch->scratch_capacities[count] = info->payload_size;
+        }
+        if (file_reader_read(input, info->payload_size, batch->scratch[count], &batch->payloads[count]) != info->payload_size) {
+            return -1;
+        }
+        count++;
+    }
+    return (long)count;
+}
+
 int huffman_decompress(const char* input_file, const char* output_file) {
-    FILE* input = fopen(input_file, "r");
-    FILE* output = fopen(output_file, "wb");
-    if (!input || !output) {
+    HuffmanOptions options;
+    huffman_default_options(&options);
+    return huffman_decompress_with_options(input_file, output_file, &options);
+}
+
+// Dekoduje i sprawdza wszystkie bloki; bez pliku wyjściowego (output_file == NULL) tylko weryfikuje
+static int decompress_file(const char* input_file, const char* output_file, const HuffmanOptions* options) {
+    double start = huffman_stats_wall_clock(), io_seconds = 0;
+    FileReader input;
+    FileWriter output;
+    int input_open = file_reader_open(&input, input_file);
+    int output_open = input_open && (!output_file || file_writer_open(&output, output_file));
+    if (!input_open || !output_open) {
         printf("Błąd: Nie udało się otworzyć plików!\n");
-        if (input) fclose(input);
-        if (output) fclose(output);
+        if (input_open) file_reader_close(&input);
         return 0;
     }
 
-    char line[1024];
-    char codes[MAX_CHARS][MAX_CODE_LEN];
-    int code_lengths[MAX_CHARS];
-    for (int i = 0; i < MAX_CHARS; i++) {
-        codes[i][0] = '\0';
-        code_lengths[i] = 0;
+    unsigned char header[HUFFMAN_FILE_HEADER_SIZE];
+    uint32_t block_size = 0;
+    if (!read_exact(&input, header, sizeof(header)) ||
+        !huffman_parse_file_header(header, &block_size)) {
+        printf("Błąd: Nieprawidłowy nagłówek pliku skompresowanego!\n");
+        file_reader_close(&input);
+        if (output_file) file_writer_close(&output);
+        return 0;
     }
 
-    if (!fgets(line, sizeof(line), input)) {
-        fclose(input);
-        fclose(output);
-        return 0;
+    ThreadPool* pool = threadpool_create(options->threads);
+    size_t slots = (size_t)threadpool_size(pool) * 2;
+
+    DecodeBatch batch;
+    batch.headers = (HuffmanBlockHeader*)calloc(slots, sizeof(HuffmanBlockHeader));
+    batch.payloads = (const unsigned char**)calloc(slots, sizeof(const unsigned char*));
+    batch.scratch = (unsigned char**)calloc(slots, sizeof(unsigned char*));
+    batch.scratch_capacities = (size_t*)calloc(slots, sizeof(size_t));
+    batch.outputs = (unsigned char**)calloc(slots, sizeof(unsigned char*));
+    batch.decoders = (HuffmanBlockDecoder*)calloc(slots, sizeof(HuffmanBlockDecoder));
+    batch.results = (int*)calloc(slots, sizeof(int));
+    HuffmanStats* slot_stats = options->stats ? (HuffmanStats*)calloc(slots, sizeof(HuffmanStats)) : NULL;
+
+    int ok = pool && batch.headers && batch.payloads && batch.scratch && batch.scratch_capacities &&
+             batch.outputs && batch.decoders && batch.results && (slot_stats || !options->stats);
+    for (size_t i = 0; ok && i < slots; i++) {
+        huffman_block_decoder_init(&batch.decoders[i]);
+        if (slot_stats) batch.decoders[i].stats = &slot_stats[i];
+        batch.outputs[i] = (unsigned char*)malloc(block_size);
+        if (!batch.outputs[i]) ok = 0;
     }
 
-    while (fgets(line, sizeof(line), input)) {
-        if (strncmp(line, "DANE:", 5) == 0) {
+    uint64_t original_size = 0, compressed_size = HUFFMAN_FILE_HEADER_SIZE;
+    uint32_t blocks = 0;
+    int end = 0;
+
+    while (ok && !end) {
+        double io_start = huffman_stats_clock();
+        long count = read_block_batch(&input, &batch, slots, block_size, &end);
+        io_seconds += huffman_stats_clock() - io_start;
+        if (count < 0) {
+            ok = 0;
             break;
         }
 
-        char* colon = strchr(line, ':');
-        if (!colon) continue;
-
-        char* dash = strchr(colon + 1, '-');
-        if (!dash) continue;
-
-        unsigned char ch;
-        if (strncmp(line, "SPACJA", 6) == 0) {
-            ch = ' ';
-        } else if (strncmp(line, "ENTER", 5) == 0) {
-            ch = '\n';
-        } else if (strncmp(line, "TAB", 3) == 0) {
-            ch = '\t';
-        } else if (line[0] == '\\' && line[1] == 'x') {
-            int hex_val;
-            sscanf(line, "\\x%02X", &hex_val);
-            ch = (unsigned char)hex_val;
-        } else {
-            ch = line[0];
-        }
+        threadpool_for(pool, (size_t)count, decode_batch_task, &batch);
 
-        dash++;
-        while (*dash == ' ' || *dash == '\t') dash++;
-        int code_len = 0;
-        while (*dash != '\n' && *dash != '\r' && *dash != '\0' && code_len < MAX_CODE_LEN - 1) {
-            codes[ch][code_len++] = *dash++;
+        io_start = huffman_stats_clock();
+        for (long i = 0; ok && i < count; i++) {
+            if (!batch.results[i]) printf("Błąd: Uszkodzony blok nr %u!\n", blocks);
+            ok = batch.results[i] &&
+                 (!output_file || file_writer_write(&output, batch.outputs[i], batch.headers[i].raw_size));
+            original_size += batch.headers[i].raw_size;
+            compressed_size += HUFFMAN_BLOCK_HEADER_SIZE + batch.headers[i].payload_size;
+            blocks++;
         }
-        codes[ch][code_len] = '\0';
-        code_lengths[ch] = code_len;
+        io_seconds += huffman_stats_clock() - io_start;
     }
 
-    typedef struct {
-        char code[MAX_CODE_LEN];
-        unsigned char character;
-    } ReverseCode;
-
-    ReverseCode reverse_codes[256];
-    int reverse_count = 0;
-    for (int i = 0; i < MAX_CHARS; i++) {
-        if (code_lengths[i] > 0) {
-            strcpy(reverse_codes[reverse_count].code, codes[i]);
-            reverse_codes[reverse_count].character = (unsigned char)i;
-            reverse_count++;
+    // Indeks bloków i stopka: liczba bloków musi się zgadzać, a za stopką nie może być nic więcej
+    if (ok) {
+        unsigned char buf[HUFFMAN_TRAILER_SIZE];
+        HuffmanIndexCheck check;
+        huffman_index_check_init(&check, block_size, compressed_size);
+        ok = read_exact(&input, buf, 4) && bitstream_load_le32(buf) == blocks;
+        for (uint32_t i = 0; ok && i < blocks; i++) {
+            ok = read_exact(&input, buf, HUFFMAN_INDEX_ENTRY_SIZE) && huffman_index_check_entry(&check, buf, NULL, NULL);
         }
+        const unsigned char* rest;
+        ok = ok && read_exact(&input, buf, HUFFMAN_TRAILER_SIZE) &&
+             huffman_index_check_trailer(&check, buf, original_size) &&
+             file_reader_read(&input, 1, buf, &rest) == 0;
     }
 
-    long data_start_pos = ftell(input);
-    long padding_pos = -1;
-    int padding = 0;
-    
-    while (fgets(line, sizeof(line), input)) {
-        if (strncmp(line, "PADDING:", 8) == 0) {
-            padding_pos = ftell(input) - strlen(line);
-            sscanf(line, "PADDING: %d", &padding);
-            break;
+    if (options->stats) {
+        huffman_stats_reset(options->stats);
+        for (size_t i = 0; slot_stats && i < slots; i++) {
+            huffman_stats_add(options->stats, &slot_stats[i]);
         }
+        options->stats->io_seconds = io_seconds;
+        options->stats->bytes_in = compressed_size + 1 + 4 + (uint64_t)blocks * HUFFMAN_INDEX_ENTRY_SIZE + HUFFMAN_TRAILER_SIZE;
+        options->stats->bytes_out = original_size;
     }
-    
-    if (padding_pos == -1) {
-        printf("Błąd: Nie znaleziono linii PADDING w pliku!\n");
-        fclose(input);
-        fclose(output);
-        return 0;
+
+    for (size_t i = 0; i < slots; i++) {
+        if (batch.scratch) free(batch.scratch[i]);
+        if (batch.outputs) free(batch.outputs[i]);
+        if (batch.decoders) huffman_block_decoder_free(&batch.decoders[i]);
     }
-    fseek(input, data_start_pos, SEEK_SET);
-
-    char current_code[MAX_CODE_LEN] = {0};
-    int code_pos = 0;
-
-    long bytes_to_read = padding_pos - data_start_pos - 1; 
-    
-    int byte;
-    long bytes_read = 0;
-    while (bytes_read < bytes_to_read && (byte = fgetc(input)) != EOF) {
-        int bits_to_process = (bytes_read == bytes_to_read - 1 && padding > 0) ? (8 - padding) : 8;
-        
-        for (int i = 7; i >= (8 - bits_to_process); i--) {
-            int bit = (byte >> i) & 1;
-            current_code[code_pos++] = bit + '0';
-            current_code[code_pos] = '\0';
-
-            for (int j = 0; j < reverse_count; j++) {
-                if (strcmp(current_code, reverse_codes[j].code) == 0) {
-                    fputc(reverse_codes[j].character, output);
-                    code_pos = 0;
-                    current_code[0] = '\0';
-                    break;
-                }
-            }
-        }
-        bytes_read++;
+    free(batch.headers);
+    free(batch.payloads);
+    free(batch.scratch);
+    free(batch.scratch_capacities);
+    free(batch.outputs);
+    free(batch.decoders);
+    free(batch.results);
+    free(slot_stats);
+    threadpool_destroy(pool);
+    file_reader_close(&input);
+
+    if (output_file && !file_writer_close(&output)) ok = 0;
+    if (!ok) {
+        printf("Błąd: Uszkodzone dane skompresowane!\n");
+        return 0;
     }
+    if (options->stats) options->stats->total_seconds = huffman_stats_wall_clock() - start;
 
-    fclose(input);
-    fclose(output);
-
-    printf("Dekompresja zakończona pomyślnie!\n");
+    if (!options->quiet) printf(output_file ? "Dekompresja zakończona pomyślnie!\n" : "Weryfikacja zakończona pomyślnie!\n");
     return 1;
 }
 
+int huffman_decompress_with_options(const char* input_file, const char* output_file, const HuffmanOptions* options) {
+    if (options->dictionary) return huffman_decompress_message_file(input_file, output_file, options);
+    return decompress_file(input_file, output_file, options);
+}
+
+int huffman_verify(const char* input_file) {
+    HuffmanOptions options;
+    huffman_default_options(&options);
+    return huffman_verify_with_options(input_file, &options);
+}
+
+int huffman_verify_with_options(const char* input_file, const HuffmanOptions* options) {
+    if (options->dictionary) return huffman_decompress_message_file(input_file, NULL, options);
+    return decompress_file(input_file, NULL, options);
+}
@@ -1,35 +1,272 @@
 #ifndef HUFFMAN_H
 #define HUFFMAN_H
 
-#include "priority_queue.h"
+#include <stddef.h>
 #include <stdint.h>
 
 #define MAX_CHARS 256
-#define MAX_CODE_LEN 256
-
-// Struktura węzła drzewa Huffmana
-typedef struct HuffmanNode {
-    unsigned char character;      // Znak (dla liści)
-    int frequency;                // Częstotliwość
-    struct HuffmanNode* left;     // Lewe dziecko
-    struct HuffmanNode* right;    // Prawe dziecko
-} HuffmanNode;
-
-// Struktura słownika kodów
-typedef struct {
-    unsigned char character;
-    char code[MAX_CODE_LEN];
-    int code_length;
-} CodeEntry;
-
-// Funkcje drzewa Huffmana
-HuffmanNode* huffman_create_node(unsigned char ch, int freq);
-void huffman_destroy_tree(HuffmanNode* root);
-HuffmanNode* huffman_build_tree(int frequencies[]);
-void huffman_build_codes(HuffmanNode* root, char codes[][MAX_CODE_LEN], int code_lengths[], char* current_code, int depth);
-void huffman_count_frequencies(const char* filename, int frequencies[]);
+#define HUFFMAN_TABLE_BITS 11       // Rozmiar (w bitach) głównej tablicy dekodującej
+#define HUFFMAN_MAX_DECODE_LEN 64   // Najdłuższy kod akceptowany przez dekoder
+#define HUFFMAN_MAX_CODE_LEN 32     // Najdłuższy kod tworzony przez koder (mieści się w rejestrze)
+#define HUFFMAN_DEFAULT_MAX_CODE_LEN 11
+#define HUFFMAN_IO_CHUNK (1 << 16)  // Rozmiar bloku odczytu/zapisu
+#define HUFFMAN_MAX_CONTEXTS 16     // Najwięcej tablic kodów w bloku z kontekstem rzędu 1
+#define HUFFMAN_DEFAULT_LINK_MB_S 100.0           // Domyślna przepustowość łącza w modelu kosztu kontekstu
+#define HUFFMAN_DEFAULT_CONTEXT_NS_PER_BYTE 2.5   // Dodatkowe kodowanie i dekodowanie kontekstu (zmierzone)
+#define HUFFMAN_DEFAULT_CLUSTER_NS_PER_OP 4.0     // Krok klastrowania kontekstów (zmierzone)
+#define HUFFMAN_MIN_ADAPTIVE_INTERVAL 256  // Najkrótszy odstęp między przebudowami kodów w bloku adaptacyjnym
+#define HUFFMAN_STREAMS 4           // Strumienie bitów bloku HUFFMAN_BLOCK_STREAMS
+#define HUFFMAN_STREAMS_MIN_SIZE 1024  // Krótsze bloki kodowane są jednym strumieniem
+
+// Format pliku skompresowanego (liczby little-endian):
+//   nagłówek pliku: magic "HUFZ", wersja, flagi, 2 bajty zarezerwowane, rozmiar bloku (u32)
+//   bloki: typ (u8), rozmiar oryginału (u32), rozmiar dalszej części (u32), CRC-32C oryginału (u32),
+//          tablica długości kodów kanonicznych, strumień bitów (MSB first) dopełniony do bajtu;
+//          blok wielostrumieniowy: tablica długości, tablica skoków (rozmiary pierwszych
+//          HUFFMAN_STREAMS - 1 strumieni, u32), strumienie kolejnych ćwiartek bloku;
+//          blok z kontekstem: liczba tablic K (u8), mapa 256 półbajtów (numer tablicy dla każdego
+//          poprzedniego bajtu), K tablic długości, strumień bitów (pierwszy bajt ma kontekst 0);
+//          blok adaptacyjny: limit długości kodu (u8), odstęp przebudowy N (u32), odcinki od pełnego
+//          bajtu (od HUFFMAN_STREAMS_MIN_SIZE bajtów jak blok wielostrumieniowy, krótsze jednym
+//          strumieniem); kody startują z równych liczników i są przebudowywane z dotychczasowych
+//          liczników po odcinkach 256, 512, 1024... bajtów, a od rozmiaru N co N bajtów;
+//          blok nieskompresowany: oryginał; blok RLE: jedyny bajt bloku (u8)
+//   znacznik końca bloków (typ HUFFMAN_BLOCK_END)
+//   indeks: liczba bloków (u32), dla każdego bloku położenie w pliku (u64) i rozmiar oryginału (u32)
+//   stopka: położenie indeksu (u64), rozmiar oryginału (u64), magic "HUFX"
+//
+// Wiadomość kodowana słownikiem (bez nagłówka pliku, bloków i tablicy kodów):
+//   identyfikator słownika (u32), rozmiar oryginału (u32), CRC-32C oryginału (u32),
+//   strumień bitów (MSB first) dopełniony do bajtu
+// Plik słownika: magic "HUFD", wersja, 3 bajty zarezerwowane, identyfikator (u32), długości kodów 256 symboli (u8)
+#define HUFFMAN_MAGIC "HUFZ"
+#define HUFFMAN_TRAILER_MAGIC "HUFX"
+#define HUFFMAN_FORMAT_VERSION 4
+#define HUFFMAN_FILE_HEADER_SIZE 12
+#define HUFFMAN_BLOCK_HEADER_SIZE 13
+#define HUFFMAN_INDEX_ENTRY_SIZE 12
+#define HUFFMAN_TRAILER_SIZE 20
+#define HUFFMAN_JUMP_TABLE_SIZE (4 * (HUFFMAN_STREAMS - 1))
+#define HUFFMAN_DICT_MAGIC "HUFD"
+#define HUFFMAN_DICT_VERSION 1
+#define HUFFMAN_DICT_FILE_SIZE (12 + MAX_CHARS)
+#define HUFFMAN_MESSAGE_HEADER_SIZE 12
+
+#define HUFFMAN_DEFAULT_BLOCK_SIZE (1 << 20)
+#define HUFFMAN_MIN_BLOCK_SIZE (1 << 10)
+#define HUFFMAN_MAX_BLOCK_SIZE (1 << 28)
+
+// Typy bloków
+enum {
+    HUFFMAN_BLOCK_END = 0,
+    HUFFMAN_BLOCK_HUFFMAN = 1,
+    HUFFMAN_BLOCK_CONTEXT = 2,
+    HUFFMAN_BLOCK_ADAPTIVE = 3,
+    HUFFMAN_BLOCK_STREAMS = 4,
+    HUFFMAN_BLOCK_RAW = 5,
+    HUFFMAN_BLOCK_RLE = 6
+};
+
+// Kod znaku: bity wyrównane do prawej (najstarszy bit wysyłany pierwszy) i długość
+typedef struct {
+    uint64_t bits;
+    uint8_t length;
+} HuffmanCode;
+
+// Pozycja tablicy dekodującej: liść (symbol) albo odnośnik do podtablicy
+typedef struct {
+    uint32_t value;       // Symbol (liść) albo indeks początku podtablicy
+    uint8_t bits;         // Bity zużywane przez liść / bity indeksujące podtablicę
+    uint8_t kind;         // HUFFMAN_ENTRY_*
+} HuffmanDecodeEntry;
+
+enum {
+    HUFFMAN_ENTRY_INVALID = 0,
+    HUFFMAN_ENTRY_LEAF = 1,
+    HUFFMAN_ENTRY_LINK = 2
+};
+
+// Wielopoziomowa tablica dekodująca: tablica główna + podtablice dla długich kodów
+typedef struct {
+    HuffmanDecodeEntry* entries;
+    size_t count;
+    size_t capacity;
+    int root_bits;        // Liczba bitów indeksujących tablicę główną
+    int single_level;     // Każdy indeks tablicy głównej jest liściem (brak podtablic)
+} HuffmanDecodeTable;
+
+// Statystyki kompresji i dekompresji (HuffmanOptions.stats). Czasy faz to czas procesora wątku
+// (huffman_stats_clock) sumowany po blokach i wątkach, więc przy kilku rdzeniach ich suma może
+// przekroczyć total_seconds - czas rzeczywisty całego wywołania (huffman_stats_wall_clock).
+typedef struct {
+    double count_seconds;     // Histogram
+    double tree_seconds;      // Długości kodów (koder: także klastrowanie kontekstów i przebudowy adaptacyjne)
+    double codes_seconds;     // Kody kanoniczne / tablice dekodujące
+    double coding_seconds;    // Kodowanie albo dekodowanie strumienia bitów (z sumą kontrolną)
+    double io_seconds;        // Odczyt i zapis plików
+    double total_seconds;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t blocks;
+    uint64_t symbols;         // Symbole zakodowane w strumieniach bitów
+    uint64_t code_bits;       // Bity strumieni (bez nagłówków i tablic kodów)
+    double entropy_bits;      // Suma entropii rzędu 0 histogramów bloków (tylko kompresja)
+    int max_code_length;      // Najdłuższy użyty kod (kompresja) albo odczytany z tablic bloków (dekompresja)
+} HuffmanStats;
+
+// Sprawdzanie indeksu bloków i stopki, wspólne dla wszystkich dekoderów: wpisy rosną, wskazują na
+// bloki przed znacznikiem końca (blocks_end) i mają rozmiary do block_size, a ich suma, rozmiar
+// oryginału ze stopki i rozmiar zdekodowany są równe
+typedef struct {
+    uint32_t block_size;
+    uint64_t blocks_end;      // Położenie znacznika końca bloków (indeks zaczyna się bajt dalej)
+    uint64_t previous_offset;
+    uint64_t indexed_size;    // Suma rozmiarów oryginału ze sprawdzonych wpisów
+    uint32_t entries;
+} HuffmanIndexCheck;
+
+// Tablice dekodujące wielokrotnego użytku dla kolejnych bloków (po jednej na kontekst)
+typedef struct {
+    HuffmanDecodeTable tables[HUFFMAN_MAX_CONTEXTS];
+    uint32_t* context_entries;    // Spłaszczone tablice bloku z kontekstem (patrz decode_context)
+    size_t context_capacity;
+    int max_code_length;      // Najdłuższy kod ostatnio dekodowanego bloku
+    HuffmanStats* stats;      // Statystyki dekodowanych bloków (NULL = bez pomiarów)
+} HuffmanBlockDecoder;
+
+// Ustawienia kompresji
+typedef struct {
+    int max_code_length;  // Limit długości kodu (1-HUFFMAN_MAX_CODE_LEN); podnoszony, gdy symboli jest więcej niż 2^limit
+    size_t block_size;    // Rozmiar niezależnie kodowanego bloku
+    int threads;          // Liczba wątków kodujących/dekodujących (0 = wszystkie rdzenie)
+    int context_tables;   // Tablice kodów dla kontekstów rzędu 1 (0 = wyłączone, 2-HUFFMAN_MAX_CONTEXTS)
+    // Model kosztu bloku z kontekstem: wybierany jest, gdy krótsze przesłanie łączem link_mb_per_s
+    // (0 = sam rozmiar) oszczędza więcej czasu, niż kosztuje dodatkowe kodowanie i dekodowanie
+    // (context_ns_per_byte) oraz klastrowanie (cluster_ns_per_op na krok: iteracja x klaster x
+    // (256 + niezerowe pary kontekst-symbol))
+    double link_mb_per_s;
+    double context_ns_per_byte;
+    double cluster_ns_per_op;
+    size_t adaptive_interval;  // Tryb jednoprzebiegowy: przebudowa kodów co tyle bajtów (0 = wyłączony);
+                               // ma pierwszeństwo przed context_tables. Wynik nadal wydawany jest
+                               // całymi blokami (patrz opóźnienie przy API strumieniowym)
+    int quiet;            // Bez komunikatu o powodzeniu (błędy są wypisywane zawsze)
+    HuffmanStats* stats;  // Gdy nie NULL: nadpisywane przez (de)kompresję pliku, sumowane przez koder strumieniowy
+    const struct HuffmanDictionary* dictionary;  // Gdy nie NULL: plik to jedna wiadomość kodowana słownikiem
+} HuffmanOptions;
+
+// Nagłówek bloku
+typedef struct {
+    int type;
+    uint32_t raw_size;
+    uint32_t payload_size;  // Bajty po nagłówku bloku (tablica kodów + strumień bitów)
+    uint32_t checksum;
+} HuffmanBlockHeader;
+
+// Funkcje kodu Huffmana
+int huffman_code_lengths(const uint64_t frequencies[], HuffmanCode codes[]);
+int huffman_limit_code_lengths(const uint64_t frequencies[], HuffmanCode codes[], int max_len);
+void huffman_assign_canonical_codes(HuffmanCode codes[]);
+void huffman_count_frequencies(const char* filename, uint64_t frequencies[]);
+void huffman_default_options(HuffmanOptions* options);
+void huffman_stats_reset(HuffmanStats* stats);
+double huffman_stats_clock(void);
+double huffman_stats_wall_clock(void);
+void huffman_stats_add(HuffmanStats* dst, const HuffmanStats* src);
+void huffman_print_stats(const HuffmanStats* stats);
 int huffman_compress(const char* input_file, const char* output_file);
+int huffman_compress_with_options(const char* input_file, const char* output_file, const HuffmanOptions* options);
 int huffman_decompress(const char* input_file, const char* output_file);
+int huffman_decompress_with_options(const char* input_file, const char* output_file, const HuffmanOptions* options);
+int huffman_verify(const char* input_file);
+int huffman_verify_with_options(const char* input_file, const HuffmanOptions* options);
+
+// Funkcje bloków
+void huffman_write_file_header(unsigned char* p, uint32_t block_size);
+int huffman_parse_file_header(const unsigned char* p, uint32_t* block_size);
+size_t huffman_block_bound(size_t raw_size, const HuffmanOptions* options);
+size_t huffman_encode_block(const unsigned char* data, size_t size, const HuffmanOptions* options, unsigned char* out,
+                            HuffmanStats* stats);
+// Odrzuca nieznany typ i rozmiar części większy, niż mógłby utworzyć koder (dla HUFFMAN_MAX_CODE_LEN)
+int huffman_read_block_header(const unsigned char* p, HuffmanBlockHeader* header);
+int huffman_decode_block(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder);
+void huffman_block_decoder_init(HuffmanBlockDecoder* decoder);
+void huffman_index_check_init(HuffmanIndexCheck* check, uint32_t block_size, uint64_t blocks_end);
+int huffman_index_check_entry(HuffmanIndexCheck* check, const unsigned char* entry, uint64_t* offset, uint32_t* raw_size);
+int huffman_index_check_trailer(const HuffmanIndexCheck* check, const unsigned char* trailer, uint64_t original_size);
+void huffman_block_decoder_free(HuffmanBlockDecoder* decoder);
+
+// Strumieniowe API na buforach wywołującego (jeden przebieg, histogram liczony dla każdego bloku).
+// Opóźnienie: blok wydawany jest dopiero w całości, bo jego nagłówek zawiera rozmiar części i CRC-32C,
+// a blok nieściśliwy zapisywany jest bez kodowania. Także w trybie adaptacyjnym pierwszy bajt wyniku
+// pojawia się więc po block_size bajtach wejścia albo po flush, a pamięć to bufor jednego bloku
+// wejścia i jednego wyniku. flush zamyka bieżący, niepełny blok i wydaje go od razu (np. dla
+// strumieni logów lub potoków); w trybie adaptacyjnym krótki blok nie płaci za tablicę kodów.
+// update zwraca HUFFMAN_STREAM_DONE, gdy całe wejście zostało przyjęte (część wyniku może czekać
+// w kontekście), albo HUFFMAN_STREAM_MORE, gdy zabrakło miejsca w buforze wyjściowym.
+// finish i dekoder zwracają HUFFMAN_STREAM_DONE dopiero po wydaniu całego wyniku.
+enum {
+    HUFFMAN_STREAM_ERROR = 0,
+    HUFFMAN_STREAM_DONE = 1,
+    HUFFMAN_STREAM_MORE = 2
+};
+
+typedef struct HuffmanEncoder HuffmanEncoder;
+typedef struct HuffmanDecoder HuffmanDecoder;
+
+HuffmanEncoder* huffman_encoder_create(const HuffmanOptions* options);
+void huffman_encoder_destroy(HuffmanEncoder* encoder);
+int huffman_encoder_update(HuffmanEncoder* encoder, const unsigned char* in, size_t in_size, size_t* in_consumed,
+                           unsigned char* out, size_t out_capacity, size_t* out_produced);
+int huffman_encoder_flush(HuffmanEncoder* encoder, unsigned char* out, size_t out_capacity, size_t* out_produced);
+int huffman_encoder_finish(HuffmanEncoder* encoder, unsigned char* out, size_t out_capacity, size_t* out_produced);
+
+HuffmanDecoder* huffman_decoder_create(void);
+void huffman_decoder_destroy(HuffmanDecoder* decoder);
+int huffman_decoder_update(HuffmanDecoder* decoder, const unsigned char* in, size_t in_size, size_t* in_consumed,
+                           unsigned char* out, size_t out_capacity, size_t* out_produced);
+
+size_t huffman_compress_bound(size_t size, const HuffmanOptions* options);
+int huffman_compress_buffer(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_capacity,
+                            size_t* out_size, const HuffmanOptions* options);
+int huffman_decompress_buffer(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_capacity,
+                              size_t* out_size);
+
+// Dostęp swobodny do pliku skompresowanego: dekodowane są tylko bloki obejmujące zakres
+typedef struct HuffmanArchive HuffmanArchive;
+
+HuffmanArchive* huffman_archive_open(const char* filename);
+void huffman_archive_close(HuffmanArchive* archive);
+uint64_t huffman_archive_size(const HuffmanArchive* archive);
+int64_t huffman_archive_read(HuffmanArchive* archive, uint64_t offset, size_t length, unsigned char* out);
+int64_t huffman_decompress_range(const char* input_file, uint64_t offset, size_t length, unsigned char* out);
+
+// Słownik: stałe kody wytrenowane na próbkach, wspólne dla wielu krótkich wiadomości (np. RPC).
+// Wiadomość nie przechodzi przez histogram ani budowę kodów, a tablica dekodująca budowana jest raz
+// (przy trenowaniu albo wczytaniu) i potem tylko czytana, więc słownik można współdzielić między wątkami.
+typedef struct HuffmanDictionary {
+    uint32_t id;
+    HuffmanCode codes[MAX_CHARS];     // Każdy bajt ma kod, także nieobecny w próbkach
+    HuffmanDecodeTable table;
+} HuffmanDictionary;
+
+int huffman_dictionary_train(HuffmanDictionary* dict, uint32_t id, const uint64_t frequencies[], int max_code_length);
+int huffman_dictionary_save(const HuffmanDictionary* dict, const char* filename);
+int huffman_dictionary_load(HuffmanDictionary* dict, const char* filename);
+void huffman_dictionary_free(HuffmanDictionary* dict);
+
+size_t huffman_message_bound(const HuffmanDictionary* dict, size_t size);
+size_t huffman_encode_message(const HuffmanDictionary* dict, const unsigned char* data, size_t size, unsigned char* out);
+uint32_t huffman_message_dictionary_id(const unsigned char* in, size_t in_size);
+int huffman_decode_message(const HuffmanDictionary* dict, const unsigned char* in, size_t in_size,
+                           unsigned char* out, size_t out_capacity, size_t* out_size);
+int huffman_compress_message_file(const char* input_file, const char* output_file, const HuffmanOptions* options);
+int huffman_decompress_message_file(const char* input_file, const char* output_file, const HuffmanOptions* options);
+
+// Funkcje tablicy dekodującej
+void huffman_decode_table_init(HuffmanDecodeTable* table);
+int huffman_decode_table_build(HuffmanDecodeTable* table, const HuffmanCode codes[]);
+void huffman_decode_table_free(HuffmanDecodeTable* table);
 
 #endif // HUFFMAN_H
 
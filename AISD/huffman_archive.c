@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "huffman.h"
+#include "bitstream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+struct HuffmanArchive {
+    FILE* file;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint64_t* block_offsets;      // Położenie nagłówka bloku w pliku
+    uint64_t* raw_offsets;        // Początek bloku w oryginale (block_count + 1 pozycji)
+
+    HuffmanBlockDecoder block_decoder;
+    unsigned char* payload;
+    size_t payload_capacity;
+    unsigned char* block;         // Ostatnio zdekodowany blok
+    long cached_block;
+};
+
+HuffmanArchive* huffman_archive_open(const char* filename) {
+    HuffmanArchive* archive = (HuffmanArchive*)calloc(1, sizeof(HuffmanArchive));
+    if (!archive) return NULL;
+    huffman_block_decoder_init(&archive->block_decoder);
+    archive->cached_block = -1;
+
+    archive->file = fopen(filename, "rb");
+    if (!archive->file) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+
+    unsigned char header[HUFFMAN_FILE_HEADER_SIZE];
+    unsigned char trailer[HUFFMAN_TRAILER_SIZE];
+    if (fread(header, 1, sizeof(header), archive->file) != sizeof(header) ||
+        !huffman_parse_file_header(header, &archive->block_size) ||
+        fseeko(archive->file, -(off_t)HUFFMAN_TRAILER_SIZE, SEEK_END) != 0 ||
+        fread(trailer, 1, sizeof(trailer), archive->file) != sizeof(trailer) ||
+        memcmp(trailer + 16, HUFFMAN_TRAILER_MAGIC, 4) != 0) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+
+    off_t file_size = ftello(archive->file);
+    uint64_t index_offset = bitstream_load_le64(trailer);
+    uint64_t original_size = bitstream_load_le64(trailer + 8);
+    unsigned char count_buf[4];
+    if (file_size < 0 || index_offset <= HUFFMAN_FILE_HEADER_SIZE || index_offset > (uint64_t)file_size ||
+        fseeko(archive->file, (off_t)index_offset, SEEK_SET) != 0 ||
+        fread(count_buf, 1, 4, archive->file) != 4) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+
+    // Liczba bloków pochodzi z pliku: indeks musi dokładnie wypełniać resztę pliku, zanim
+    // zostaną zaalokowane tablice o rozmiarze zależnym od niej
+    archive->block_count = bitstream_load_le32(count_buf);
+    if (index_offset + 4 + (uint64_t)archive->block_count * HUFFMAN_INDEX_ENTRY_SIZE + HUFFMAN_TRAILER_SIZE !=
+        (uint64_t)file_size) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+    archive->block_offsets = (uint64_t*)malloc(((size_t)archive->block_count + 1) * sizeof(uint64_t));
+    archive->raw_offsets = (uint64_t*)malloc(((size_t)archive->block_count + 1) * sizeof(uint64_t));
+    archive->block = (unsigned char*)malloc(archive->block_size);
+    if (!archive->block_offsets || !archive->raw_offsets || !archive->block) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+
+    // Bloki nie są tu dekodowane, więc znacznik końca leży tuż przed indeksem (index_offset - 1)
+    HuffmanIndexCheck check;
+    huffman_index_check_init(&check, archive->block_size, index_offset - 1);
+    archive->raw_offsets[0] = 0;
+    for (uint32_t i = 0; i < archive->block_count; i++) {
+        unsigned char entry[HUFFMAN_INDEX_ENTRY_SIZE];
+        uint32_t raw_size;
+        if (fread(entry, 1, sizeof(entry), archive->file) != sizeof(entry) ||
+            !huffman_index_check_entry(&check, entry, &archive->block_offsets[i], &raw_size)) {
+            huffman_archive_close(archive);
+            return NULL;
+        }
+        archive->raw_offsets[i + 1] = archive->raw_offsets[i] + raw_size;
+    }
+
+    if (!huffman_index_check_trailer(&check, trailer, original_size)) {
+        huffman_archive_close(archive);
+        return NULL;
+    }
+    return archive;
+}
+
+void huffman_archive_close(HuffmanArchive* archive) {
+    if (!archive) return;
+    if (archive->file) fclose(archive->file);
+    free(archive->block_offsets);
+    free(archive->raw_offsets);
+    free(archive->payload);
+    free(archive->block);
+    huffman_block_decoder_free(&archive->block_decoder);
+    free(archive);
+}
+
+uint64_t huffman_archive_size(const HuffmanArchive* archive) {
+    return archive ? archive->raw_offsets[archive->block_count] : 0;
+}
+
+// Dekoduje blok `index` do archive->block (o ile nie jest już w pamięci)
+static int load_block(HuffmanArchive* archive, uint32_t index) {
+    if (archive->cached_block == (long)index) return 1;
+    archive->cached_block = -1;
+
+    unsigned char block_header[HUFFMAN_BLOCK_HEADER_SIZE];
+    HuffmanBlockHeader info;
+    if (fseeko(archive->file, (off_t)archive->block_offsets[index], SEEK_SET) != 0 ||
+        fread(block_header, 1, sizeof(block_header), archive->file) != sizeof(block_header) ||
+        !huffman_read_block_header(block_header, &info) ||
+        info.raw_size != archive->raw_offsets[index + 1] - archive->raw_offsets[index]) {
+        return 0;
+    }
+
+    if (info.payload_size > archive->payload_capacity) {
+        unsigned char* payload = (unsigned char*)realloc(archive->payload, info.payload_size);
+        if (!payload) return 0;
+        archive->payload = payload;
+        archive->payload_capacity = info.payload_size;
+    }
+
+    if (fread(archive->payload, 1, info.payload_size, archive->file) != info.payload_size ||
+        !huffman_decode_block(&info, archive->payload, archive->block, &archive->block_decoder)) {
+        return 0;
+    }
+
+    archive->cached_block = (long)index;
+    return 1;
+}
+
+int64_t huffman_archive_read(HuffmanArchive* archive, uint64_t offset, size_t length, unsigned char* out) {
+    if (!archive) return -1;
+
+    uint64_t size = huffman_archive_size(archive);
+    if (offset >= size) return 0;
+    if (length > size - offset) length = (size_t)(size - offset);
+
+    // Ostatni blok zaczynający się nie później niż `offset`
+    uint32_t lo = 0, hi = archive->block_count - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo + 1) / 2;
+        if (archive->raw_offsets[mid] <= offset) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    size_t copied = 0;
+    for (uint32_t i = lo; copied < length; i++) {
+        if (!load_block(archive, i)) return -1;
+
+        size_t start = (size_t)(offset + copied - archive->raw_offsets[i]);
+        size_t n = (size_t)(archive->raw_offsets[i + 1] - archive->raw_offsets[i]) - start;
+        if (n > length - copied) n = length - copied;
+        memcpy(out + copied, archive->block + start, n);
+        copied += n;
+    }
+
+    return (int64_t)copied;
+}
+
+int64_t huffman_decompress_range(const char* input_file, uint64_t offset, size_t length, unsigned char* out) {
+    HuffmanArchive* archive = huffman_archive_open(input_file);
+    if (!archive) return -1;
+
+    int64_t result = huffman_archive_read(archive, offset, length, out);
+    huffman_archive_close(archive);
+    return result;
+}
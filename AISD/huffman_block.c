@@ -0,0 +1,1075 @@
+#include "huffman.h"
+#include "bitstream.h"
+#include "checksum.h"
+#include "histogram.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int longest_code(const HuffmanCode codes[]) {
+    int longest = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (codes[i].length > longest) longest = codes[i].length;
+    }
+    return longest;
+}
+
+// Entropia rzędu 0 histogramu w bitach (dolna granica długości strumienia kodów prefiksowych)
+static double histogram_entropy(const uint64_t frequencies[], size_t size) {
+    double bits = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (frequencies[i] > 0) bits -= (double)frequencies[i] * log2((double)frequencies[i] / (double)size);
+    }
+    return bits;
+}
+
+// Największa część bloku za nagłówkiem, jaką tworzy koder z danym limitem długości kodu
+static size_t payload_bound(size_t raw_size, int max_code_length) {
+    size_t max_bits = max_code_length > 8 ? (size_t)max_code_length : 8;
+    // Odcinki bloku adaptacyjnego: do HUFFMAN_JUMP_TABLE_SIZE + HUFFMAN_STREAMS bajtów narzutu
+    // na każde HUFFMAN_STREAMS_MIN_SIZE bajtów (krótsze odcinki tylko bajt dopełnienia na 256 B)
+    size_t segments = raw_size / HUFFMAN_STREAMS_MIN_SIZE * (HUFFMAN_JUMP_TABLE_SIZE + HUFFMAN_STREAMS);
+    return 3 + MAX_CHARS + HUFFMAN_JUMP_TABLE_SIZE + (raw_size * max_bits + 7) / 8 + HUFFMAN_STREAMS + 8 + segments;
+}
+
+size_t huffman_block_bound(size_t raw_size, const HuffmanOptions* options) {
+    return HUFFMAN_BLOCK_HEADER_SIZE + payload_bound(raw_size, options->max_code_length);
+}
+
+void huffman_write_file_header(unsigned char* p, uint32_t block_size) {
+    memcpy(p, HUFFMAN_MAGIC, 4);
+    p[4] = HUFFMAN_FORMAT_VERSION;
+    p[5] = 0;
+    p[6] = 0;
+    p[7] = 0;
+    bitstream_store_le32(p + 8, block_size);
+}
+
+int huffman_parse_file_header(const unsigned char* p, uint32_t* block_size) {
+    if (memcmp(p, HUFFMAN_MAGIC, 4) != 0 || p[4] != HUFFMAN_FORMAT_VERSION) return 0;
+    *block_size = bitstream_load_le32(p + 8);
+    return *block_size >= HUFFMAN_MIN_BLOCK_SIZE && *block_size <= HUFFMAN_MAX_BLOCK_SIZE;
+}
+
+int huffman_read_block_header(const unsigned char* p, HuffmanBlockHeader* header) {
+    header->type = p[0];
+    header->raw_size = bitstream_load_le32(p + 1);
+    header->payload_size = bitstream_load_le32(p + 5);
+    header->checksum = bitstream_load_le32(p + 9);
+
+    // Rozmiar z niezaufanego nagłówka: odrzucany, zanim ktokolwiek przydzieli na niego pamięć
+    if (header->payload_size > payload_bound(header->raw_size, HUFFMAN_MAX_CODE_LEN)) return 0;
+    if (header->type == HUFFMAN_BLOCK_RAW) return header->payload_size == header->raw_size;
+    if (header->type == HUFFMAN_BLOCK_RLE) return header->payload_size == 1;
+    return header->type == HUFFMAN_BLOCK_HUFFMAN || header->type == HUFFMAN_BLOCK_CONTEXT ||
+           header->type == HUFFMAN_BLOCK_ADAPTIVE || header->type == HUFFMAN_BLOCK_STREAMS;
+}
+
+void huffman_index_check_init(HuffmanIndexCheck* check, uint32_t block_size, uint64_t blocks_end) {
+    check->block_size = block_size;
+    check->blocks_end = blocks_end;
+    check->previous_offset = 0;
+    check->indexed_size = 0;
+    check->entries = 0;
+}
+
+// Wpis musi wskazywać na nagłówek bloku przed znacznikiem końca, dalej niż poprzedni wpis
+int huffman_index_check_entry(HuffmanIndexCheck* check, const unsigned char* entry, uint64_t* offset, uint32_t* raw_size) {
+    uint64_t entry_offset = bitstream_load_le64(entry);
+    uint32_t entry_size = bitstream_load_le32(entry + 8);
+    if (entry_offset < HUFFMAN_FILE_HEADER_SIZE || entry_offset >= check->blocks_end ||
+        (check->entries > 0 && entry_offset <= check->previous_offset) || entry_size > check->block_size) {
+        return 0;
+    }
+
+    check->previous_offset = entry_offset;
+    check->indexed_size += entry_size;
+    check->entries++;
+    if (offset) *offset = entry_offset;
+    if (raw_size) *raw_size = entry_size;
+    return 1;
+}
+
+int huffman_index_check_trailer(const HuffmanIndexCheck* check, const unsigned char* trailer, uint64_t original_size) {
+    return bitstream_load_le64(trailer) == check->blocks_end + 1 &&
+           bitstream_load_le64(trailer + 8) == original_size && check->indexed_size == original_size &&
+           memcmp(trailer + 16, HUFFMAN_TRAILER_MAGIC, 4) == 0;
+}
+
+// Tablica długości kodów: najdłuższy kod, pierwszy symbol, liczba symboli - 1,
+// następnie długości (półbajty, gdy najdłuższy kod ma <= 15 bitów)
+static size_t write_length_table(unsigned char* out, const HuffmanCode codes[]) {
+    int first = MAX_CHARS, last = -1, max_len = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (codes[i].length == 0) continue;
+        if (first == MAX_CHARS) first = i;
+        last = i;
+        if (codes[i].length > max_len) max_len = codes[i].length;
+    }
+    if (last < 0) {
+        first = 0;
+        last = 0;
+    }
+
+    out[0] = (unsigned char)max_len;
+    out[1] = (unsigned char)first;
+    out[2] = (unsigned char)(last - first);
+
+    size_t pos = 3;
+    int count = last - first + 1;
+    if (max_len <= 15) {
+        for (int i = 0; i < count; i += 2) {
+            int hi = codes[first + i].length;
+            int lo = i + 1 < count ? codes[first + i + 1].length : 0;
+            out[pos++] = (unsigned char)((hi << 4) | lo);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            out[pos++] = codes[first + i].length;
+        }
+    }
+    return pos;
+}
+
+// Odczytuje tablicę długości i nadaje kody kanoniczne; zwraca liczbę zużytych bajtów (0 przy błędzie)
+static size_t read_length_table(const unsigned char* in, size_t size, HuffmanCode codes[]) {
+    if (size < 3) return 0;
+
+    int max_len = in[0];
+    int first = in[1];
+    int count = in[2] + 1;
+    if (max_len > HUFFMAN_MAX_DECODE_LEN || first + count > MAX_CHARS) return 0;
+
+    size_t table_size = max_len <= 15 ? (size_t)(count + 1) / 2 : (size_t)count;
+    if (3 + table_size > size) return 0;
+
+    const unsigned char* table = in + 3;
+    memset(codes, 0, MAX_CHARS * sizeof(HuffmanCode));
+    for (int i = 0; i < count; i++) {
+        int len = max_len <= 15 ? (i % 2 == 0 ? table[i / 2] >> 4 : table[i / 2] & 0x0F) : table[i];
+        if (len > max_len) return 0;
+        codes[first + i].length = (uint8_t)len;
+    }
+
+    huffman_assign_canonical_codes(codes);
+    return 3 + table_size;
+}
+
+static size_t length_table_size(const HuffmanCode codes[]) {
+    int first = -1, last = 0, max_len = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (codes[i].length == 0) continue;
+        if (first < 0) first = i;
+        last = i;
+        if (codes[i].length > max_len) max_len = codes[i].length;
+    }
+    size_t count = first < 0 ? 1 : (size_t)(last - first + 1);
+    return 3 + (max_len <= 15 ? (count + 1) / 2 : count);
+}
+
+// Długości kodów dla histogramu; jedyny symbol dostaje kod 1-bitowy (kod z jednym symbolem ma długość 0)
+static int build_block_lengths(const uint64_t frequencies[], int max_len, HuffmanCode codes[]) {
+    // Długości kodów liczone w miejscu, bez drzewa i kolejki priorytetowej
+    if (huffman_code_lengths(frequencies, codes) == 1) {
+        for (int i = 0; i < MAX_CHARS; i++) {
+            if (frequencies[i] > 0) codes[i].length = 1;
+        }
+        return 1;
+    }
+    return huffman_limit_code_lengths(frequencies, codes, max_len);
+}
+
+static int build_block_codes(const uint64_t frequencies[], int max_len, HuffmanCode codes[]) {
+    if (!build_block_lengths(frequencies, max_len, codes)) return 0;
+    huffman_assign_canonical_codes(codes);
+    return 1;
+}
+
+static uint64_t coded_bits(const uint64_t frequencies[], const HuffmanCode codes[]) {
+    uint64_t bits = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        bits += frequencies[i] * codes[i].length;
+    }
+    return bits;
+}
+
+#define CONTEXT_ITERATIONS 4
+#define CONTEXT_SAMPLE_SIZE (1 << 14)  // Próbka bloku, z której szacowany jest zysk z kontekstu
+#define CONTEXT_FLAT_BITS 9    // Szerokość spłaszczonych tablic dekodera bloku z kontekstem
+
+// Grupuje konteksty (poprzednie bajty) w najwyżej k klastrów metodą k-średnich z kosztem w bitach:
+// kontekst trafia do klastra, którego rozkład najtaniej koduje symbole występujące po nim.
+// Zarodkami są najczęstsze konteksty. Wiersze liczników przechodzone są tylko po niezerowych
+// pozycjach (`nonzero` par kontekst-symbol), więc krok kosztuje k * nonzero zamiast k * 256 * n.
+// Zwraca liczbę niepustych klastrów albo -1 przy braku pamięci.
+static int cluster_contexts(const uint32_t* counts, const uint64_t totals[], size_t nonzero, int k,
+                            uint8_t map[], uint64_t cluster_freq[][MAX_CHARS]) {
+    int active[MAX_CHARS], n = 0;
+    for (int c = 0; c < MAX_CHARS; c++) {
+        map[c] = 0;
+        if (totals[c] == 0) continue;
+
+        // Sortowanie przez wstawianie, malejąco po liczbie wystąpień
+        int pos = n++;
+        while (pos > 0 && totals[active[pos - 1]] < totals[c]) {
+            active[pos] = active[pos - 1];
+            pos--;
+        }
+        active[pos] = c;
+    }
+
+    // Niezerowe pozycje wierszy aktywnych kontekstów, rosnąco po symbolu
+    uint8_t* symbols = (uint8_t*)malloc(nonzero > 0 ? nonzero : 1);
+    uint32_t* values = (uint32_t*)malloc((nonzero > 0 ? nonzero : 1) * sizeof(uint32_t));
+    size_t row_start[MAX_CHARS + 1];
+    if (!symbols || !values) {
+        free(symbols);
+        free(values);
+        return -1;
+    }
+    size_t filled = 0;
+    for (int i = 0; i < n; i++) {
+        const uint32_t* row = counts + active[i] * MAX_CHARS;
+        row_start[i] = filled;
+        for (int s = 0; s < MAX_CHARS; s++) {
+            if (row[s] == 0) continue;
+            symbols[filled] = (uint8_t)s;
+            values[filled] = row[s];
+            filled++;
+        }
+    }
+    row_start[n] = filled;
+
+    int clusters = n < k ? n : k;
+    for (int j = 0; j < clusters; j++) {
+        map[active[j]] = (uint8_t)j;
+    }
+
+    if (n > k) {
+        float cost[HUFFMAN_MAX_CONTEXTS][MAX_CHARS];
+        for (int j = 0; j < k; j++) {
+            for (int s = 0; s < MAX_CHARS; s++) cluster_freq[j][s] = counts[active[j] * MAX_CHARS + s];
+        }
+
+        for (int iter = 0; iter < CONTEXT_ITERATIONS; iter++) {
+            for (int j = 0; j < k; j++) {
+                uint64_t total = 0;
+                for (int s = 0; s < MAX_CHARS; s++) total += cluster_freq[j][s];
+                float log_total = log2f((float)total + 1.0f);
+                for (int s = 0; s < MAX_CHARS; s++) {
+                    cost[j][s] = log_total - log2f((float)cluster_freq[j][s] + 0.1f);
+                }
+            }
+
+            for (int i = 0; i < n; i++) {
+                float best_cost = 0;
+                int best = 0;
+                for (int j = 0; j < k; j++) {
+                    float c = 0;
+                    for (size_t t = row_start[i]; t < row_start[i + 1]; t++) {
+                        c += (float)values[t] * cost[j][symbols[t]];
+                    }
+                    if (j == 0 || c < best_cost) {
+                        best_cost = c;
+                        best = j;
+                    }
+                }
+                map[active[i]] = (uint8_t)best;
+            }
+
+            memset(cluster_freq, 0, (size_t)k * sizeof(cluster_freq[0]));
+            for (int i = 0; i < n; i++) {
+                uint64_t* freq = cluster_freq[map[active[i]]];
+                for (size_t t = row_start[i]; t < row_start[i + 1]; t++) freq[symbols[t]] += values[t];
+            }
+        }
+    }
+
+    // Numeracja niepustych klastrów od zera
+    int renumber[HUFFMAN_MAX_CONTEXTS];
+    int used = 0;
+    for (int j = 0; j < HUFFMAN_MAX_CONTEXTS; j++) renumber[j] = -1;
+    for (int i = 0; i < n; i++) {
+        int j = map[active[i]];
+        if (renumber[j] < 0) renumber[j] = used++;
+    }
+    for (int c = 0; c < MAX_CHARS; c++) {
+        map[c] = totals[c] > 0 ? (uint8_t)renumber[map[c]] : 0;
+    }
+
+    memset(cluster_freq, 0, (size_t)used * sizeof(cluster_freq[0]));
+    for (int i = 0; i < n; i++) {
+        uint64_t* freq = cluster_freq[map[active[i]]];
+        for (size_t t = row_start[i]; t < row_start[i + 1]; t++) freq[symbols[t]] += values[t];
+    }
+    free(symbols);
+    free(values);
+    return used;
+}
+
+// Entropia warunkowa rzędu 1 liczników par w bitach (dolna granica strumienia bitów bloku z kontekstem);
+// wypełnia też sumy wierszy oraz liczbę niezerowych par i niepustych kontekstów
+static double context_entropy(const uint32_t* counts, uint64_t totals[], size_t* nonzero, int* contexts) {
+    double bits = 0;
+    *nonzero = 0;
+    *contexts = 0;
+    for (int c = 0; c < MAX_CHARS; c++) {
+        const uint32_t* row = counts + c * MAX_CHARS;
+        totals[c] = 0;
+        for (int s = 0; s < MAX_CHARS; s++) totals[c] += row[s];
+        if (totals[c] == 0) continue;
+
+        (*contexts)++;
+        for (int s = 0; s < MAX_CHARS; s++) {
+            if (row[s] == 0) continue;
+            (*nonzero)++;
+            bits -= (double)row[s] * log2((double)row[s] / (double)totals[c]);
+        }
+    }
+    return bits;
+}
+
+// Szacowany czas klastrowania `contexts` kontekstów o `nonzero` niezerowych parach (0, gdy
+// kontekstów jest nie więcej niż tablic): każda iteracja liczy koszty 256 symboli i przechodzi
+// niezerowe pary dla każdego klastra
+static double context_cluster_ns(const HuffmanOptions* options, int contexts, size_t nonzero) {
+    if (contexts <= options->context_tables) return 0;
+    double steps = (double)CONTEXT_ITERATIONS * options->context_tables * (double)(MAX_CHARS + nonzero);
+    return steps * options->cluster_ns_per_op;
+}
+
+// Czy blok z kontekstem o `context_size` bajtach wygrywa z blokiem o `order0_size` bajtach (rzędu 0
+// albo nieskompresowanym), gdy kosztuje dodatkowo `extra_ns` kodowania i dekodowania: oszczędność
+// przesłania łączem options->link_mb_per_s musi przewyższyć dodatkową pracę. Bez łącza liczy się rozmiar.
+static int context_pays_off(const HuffmanOptions* options, size_t context_size, size_t order0_size, double extra_ns) {
+    if (context_size >= order0_size) return 0;
+    if (options->link_mb_per_s <= 0) return 1;
+    return (double)(order0_size - context_size) * 1e3 / options->link_mb_per_s > extra_ns;
+}
+
+// Blok z kontekstem rzędu 1; zwraca 0, gdy według modelu kosztu nie wygrywa z blokiem o `order0_size`
+// bajtach. Zliczanie i klastrowanie są pomijane, gdy model przegrywa już przy dolnej granicy
+// rozmiaru bloku (sam nagłówek i mapa kontekstów, potem także entropia warunkowa).
+static size_t encode_context_block(const unsigned char* data, size_t size, const uint64_t frequencies[],
+                                   const HuffmanOptions* options, size_t order0_size, unsigned char* out,
+                                   HuffmanStats* stats) {
+    // Każdy bajt bloku (poza ostatnim) jest kontekstem z co najmniej jedną parą, co ogranicza
+    // z dołu koszt klastrowania przed zliczeniem par
+    int symbols = 0;
+    for (int c = 0; c < MAX_CHARS; c++) symbols += frequencies[c] > 0;
+    size_t min_size = HUFFMAN_BLOCK_HEADER_SIZE + 1 + MAX_CHARS / 2;
+    double extra_ns = (double)size * options->context_ns_per_byte;
+    if (!context_pays_off(options, min_size, order0_size,
+                          extra_ns + context_cluster_ns(options, symbols - 1, (size_t)symbols - 1))) {
+        return 0;
+    }
+
+    double start = stats ? huffman_stats_clock() : 0;
+    uint32_t* counts = (uint32_t*)calloc((size_t)MAX_CHARS * MAX_CHARS, sizeof(uint32_t));
+    if (!counts) return 0;
+
+    // Zliczanie par kosztuje ok. 1 ns/bajt, więc najpierw liczona jest próbka z początku bloku:
+    // gdy model przegrywa przy entropii oszacowanej z próbki, reszta bloku nie jest zliczana
+    size_t sample = size < CONTEXT_SAMPLE_SIZE ? size : CONTEXT_SAMPLE_SIZE;
+    unsigned prev = 0;
+    for (size_t i = 0; i < sample; i++) {
+        counts[prev * MAX_CHARS + data[i]]++;
+        prev = data[i];
+    }
+
+    uint64_t totals[MAX_CHARS];
+    size_t nonzero;
+    int contexts;
+    double entropy_bits = context_entropy(counts, totals, &nonzero, &contexts);
+    if (sample < size) {
+        double estimate = entropy_bits * (double)size / (double)sample;
+        double cluster_ns = context_cluster_ns(options, contexts, nonzero);
+        if (!context_pays_off(options, min_size + (size_t)(estimate / 8), order0_size, extra_ns + cluster_ns)) {
+            free(counts);
+            if (stats) stats->tree_seconds += huffman_stats_clock() - start;
+            return 0;
+        }
+        for (size_t i = sample; i < size; i++) {
+            counts[prev * MAX_CHARS + data[i]]++;
+            prev = data[i];
+        }
+        entropy_bits = context_entropy(counts, totals, &nonzero, &contexts);
+    }
+
+    // Entropia warunkowa ogranicza z dołu strumień bitów każdego podziału na klastry, więc blok,
+    // który nie wygrywa nawet z nią, nie jest klastrowany
+    extra_ns += context_cluster_ns(options, contexts, nonzero);
+    uint8_t map[MAX_CHARS];
+    uint64_t cluster_freq[HUFFMAN_MAX_CONTEXTS][MAX_CHARS];
+    int k = context_pays_off(options, min_size + (size_t)(entropy_bits / 8), order0_size, extra_ns)
+                ? cluster_contexts(counts, totals, nonzero, options->context_tables, map, cluster_freq)
+                : -1;
+    free(counts);
+    if (k < 0) {
+        if (stats) stats->tree_seconds += huffman_stats_clock() - start;
+        return 0;
+    }
+
+    HuffmanCode codes[HUFFMAN_MAX_CONTEXTS][MAX_CHARS];
+    size_t pos = HUFFMAN_BLOCK_HEADER_SIZE + 1 + MAX_CHARS / 2;
+    uint64_t bits = 0;
+    for (int j = 0; j < k; j++) {
+        if (!build_block_codes(cluster_freq[j], options->max_code_length, codes[j])) return 0;
+        pos += length_table_size(codes[j]);
+        bits += coded_bits(cluster_freq[j], codes[j]);
+    }
+
+    double modeled = stats ? huffman_stats_clock() : 0;
+    if (stats) stats->tree_seconds += modeled - start;
+    if (!context_pays_off(options, pos + (size_t)((bits + 7) / 8), order0_size, extra_ns)) return 0;
+
+    out[0] = HUFFMAN_BLOCK_CONTEXT;
+    bitstream_store_le32(out + 1, (uint32_t)size);
+    bitstream_store_le32(out + 9, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+
+    pos = HUFFMAN_BLOCK_HEADER_SIZE;
+    out[pos++] = (unsigned char)k;
+    for (int c = 0; c < MAX_CHARS; c += 2) {
+        out[pos++] = (unsigned char)((map[c] << 4) | map[c + 1]);
+    }
+    for (int j = 0; j < k; j++) {
+        pos += write_length_table(out + pos, codes[j]);
+    }
+
+    const HuffmanCode* context_codes[MAX_CHARS];
+    for (int c = 0; c < MAX_CHARS; c++) {
+        context_codes[c] = codes[map[c]];
+    }
+
+    BitWriter bw;
+    bitwriter_init(&bw, out + pos);
+    prev = 0;
+    for (size_t i = 0; i < size; i++) {
+        const HuffmanCode code = context_codes[prev][data[i]];
+        bitwriter_put(&bw, code.bits, code.length);
+        prev = data[i];
+    }
+    bitwriter_finish(&bw);
+    pos += bw.pos;
+
+    bitstream_store_le32(out + 5, (uint32_t)(pos - HUFFMAN_BLOCK_HEADER_SIZE));
+    if (stats) {
+        stats->coding_seconds += huffman_stats_clock() - modeled;
+        stats->code_bits += bits;
+        for (int j = 0; j < k; j++) {
+            if (longest_code(codes[j]) > stats->max_code_length) stats->max_code_length = longest_code(codes[j]);
+        }
+    }
+    return pos;
+}
+
+// Kody bloku adaptacyjnego z liczników; każdy symbol ma niezerowy licznik, więc dostaje kod
+static int adaptive_codes(const uint64_t counts[], int max_len, HuffmanCode codes[]) {
+    huffman_code_lengths(counts, codes);
+    if (!huffman_limit_code_lengths(counts, codes, max_len)) return 0;
+    huffman_assign_canonical_codes(codes);
+    return 1;
+}
+
+// Długość kolejnego odcinka bloku adaptacyjnego: 256, 512, 1024... aż do `interval`,
+// aby krótkie bloki (np. po flush) szybko odchodziły od kodów równomiernych
+static size_t adaptive_segment(size_t start, size_t size, size_t interval) {
+    size_t length = start < interval ? start + HUFFMAN_MIN_ADAPTIVE_INTERVAL : interval;
+    if (length > interval) length = interval;
+    return size - start > length ? start + length : size;
+}
+
+// Blok przechowywany bez kodowania (dane nieściśliwe); dekodowanie to memcpy
+static size_t encode_raw_block(const unsigned char* data, size_t size, unsigned char* out, HuffmanStats* stats) {
+    out[0] = HUFFMAN_BLOCK_RAW;
+    bitstream_store_le32(out + 1, (uint32_t)size);
+    bitstream_store_le32(out + 5, (uint32_t)size);
+    bitstream_store_le32(out + 9, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+    memcpy(out + HUFFMAN_BLOCK_HEADER_SIZE, data, size);
+    if (stats) stats->code_bits += (uint64_t)size * 8;
+    return HUFFMAN_BLOCK_HEADER_SIZE + size;
+}
+
+// Blok z jednym symbolem powtórzonym w całym bloku; dekodowanie to memset
+static size_t encode_rle_block(const unsigned char* data, size_t size, unsigned char* out) {
+    out[0] = HUFFMAN_BLOCK_RLE;
+    bitstream_store_le32(out + 1, (uint32_t)size);
+    bitstream_store_le32(out + 5, 1);
+    bitstream_store_le32(out + 9, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+    out[HUFFMAN_BLOCK_HEADER_SIZE] = data[0];
+    return HUFFMAN_BLOCK_HEADER_SIZE + 1;
+}
+
+static int single_symbol(const unsigned char* data, size_t size) {
+    for (size_t i = 1; i < size; i++) {
+        if (data[i] != data[0]) return 0;
+    }
+    return 1;
+}
+
+// Koduje data[start..end) jednym strumieniem bitów; zwraca liczbę zapisanych bajtów
+static size_t encode_symbols(const unsigned char* data, size_t start, size_t end, const HuffmanCode codes[], unsigned char* out) {
+    BitWriter bw;
+    bitwriter_init(&bw, out);
+    for (size_t i = start; i < end; i++) {
+        const HuffmanCode code = codes[data[i]];
+        bitwriter_put(&bw, code.bits, code.length);
+    }
+    bitwriter_finish(&bw);
+    return bw.pos;
+}
+
+// Bloki dzielone na HUFFMAN_STREAMS równych odcinków, każdy w osobnym strumieniu bitów
+static size_t stream_segment(size_t size) {
+    return (size + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+}
+
+// Tablica skoków (rozmiary strumieni 0..HUFFMAN_STREAMS-2), następnie strumienie po kolei
+static size_t encode_streams(const unsigned char* data, size_t size, const HuffmanCode codes[], unsigned char* out) {
+    size_t segment = stream_segment(size);
+    size_t pos = HUFFMAN_JUMP_TABLE_SIZE;
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        size_t start = (size_t)s * segment < size ? (size_t)s * segment : size;
+        size_t end = size - start > segment ? start + segment : size;
+        size_t n = encode_symbols(data, start, end, codes, out + pos);
+        if (s < HUFFMAN_STREAMS - 1) bitstream_store_le32(out + 4 * s, (uint32_t)n);
+        pos += n;
+    }
+    return pos;
+}
+
+// Blok jednoprzebiegowy: bez histogramu i tablicy długości, kody przebudowywane po każdym odcinku.
+// Odcinek zaczyna się od pełnego bajtu; odcinki od HUFFMAN_STREAMS_MIN_SIZE bajtów mają układ
+// bloku wielostrumieniowego (tablica skoków i HUFFMAN_STREAMS strumieni), krótsze jeden strumień
+static size_t encode_adaptive_block(const unsigned char* data, size_t size, const HuffmanOptions* options,
+                                    unsigned char* out, HuffmanStats* stats) {
+    double start = stats ? huffman_stats_clock() : 0, rebuild_seconds = 0;
+    int max_len = options->max_code_length, longest = 0;
+    size_t interval = options->adaptive_interval;
+
+    uint64_t counts[MAX_CHARS];
+    for (int i = 0; i < MAX_CHARS; i++) counts[i] = 1;
+    HuffmanCode codes[MAX_CHARS];
+    if (!adaptive_codes(counts, max_len, codes)) return 0;
+
+    out[0] = HUFFMAN_BLOCK_ADAPTIVE;
+    bitstream_store_le32(out + 1, (uint32_t)size);
+    bitstream_store_le32(out + 9, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+
+    size_t pos = HUFFMAN_BLOCK_HEADER_SIZE;
+    out[pos++] = (unsigned char)max_len;
+    bitstream_store_le32(out + pos, (uint32_t)interval);
+    pos += 4;
+
+    size_t coded = 0;
+    for (size_t start = 0, end; start < size; start = end) {
+        end = adaptive_segment(start, size, interval);
+        size_t n = end - start >= HUFFMAN_STREAMS_MIN_SIZE ? encode_streams(data + start, end - start, codes, out + pos + coded)
+                                                            : encode_symbols(data, start, end, codes, out + pos + coded);
+        coded += n;
+        if (stats && longest_code(codes) > longest) longest = longest_code(codes);
+        if (end < size) {
+            double rebuild = stats ? huffman_stats_clock() : 0;
+            histogram_count(data + start, end - start, counts);
+            if (!adaptive_codes(counts, max_len, codes)) return 0;
+            if (stats) rebuild_seconds += huffman_stats_clock() - rebuild;
+        }
+    }
+    if (pos + coded >= HUFFMAN_BLOCK_HEADER_SIZE + size) return encode_raw_block(data, size, out, stats);
+
+    bitstream_store_le32(out + 5, (uint32_t)(pos + coded - HUFFMAN_BLOCK_HEADER_SIZE));
+    if (stats) {
+        stats->tree_seconds += rebuild_seconds;
+        stats->coding_seconds += huffman_stats_clock() - start - rebuild_seconds;
+        stats->code_bits += (uint64_t)coded * 8;
+        if (longest > stats->max_code_length) stats->max_code_length = longest;
+
+        // Entropia wymaga histogramu całego bloku: dodatkowy przebieg tylko przy zbieraniu statystyk
+        uint64_t frequencies[MAX_CHARS] = {0};
+        histogram_count(data, size, frequencies);
+        stats->entropy_bits += histogram_entropy(frequencies, size);
+    }
+    return pos + coded;
+}
+
+size_t huffman_encode_block(const unsigned char* data, size_t size, const HuffmanOptions* options, unsigned char* out,
+                            HuffmanStats* stats) {
+    if (size == 0 || size > HUFFMAN_MAX_BLOCK_SIZE) return 0;
+    if (stats) {
+        stats->blocks++;
+        stats->symbols += size;
+    }
+    if (options->adaptive_interval > 0) {
+        // Tryb jednoprzebiegowy nie ma histogramu: ciąg jednego bajtu wykrywany jest osobno (zwykle
+        // kończy się na pierwszych bajtach), a nieściśliwość dopiero po zakodowaniu
+        if (single_symbol(data, size)) return encode_rle_block(data, size, out);
+        return encode_adaptive_block(data, size, options, out, stats);
+    }
+
+    double t0 = stats ? huffman_stats_clock() : 0;
+    uint64_t frequencies[MAX_CHARS] = {0};
+    histogram_count(data, size, frequencies);
+    double t1 = stats ? huffman_stats_clock() : 0;
+    if (frequencies[data[0]] == size) {
+        if (stats) stats->count_seconds += t1 - t0;
+        return encode_rle_block(data, size, out);
+    }
+
+    HuffmanCode codes[MAX_CHARS];
+    if (!build_block_lengths(frequencies, options->max_code_length, codes)) return 0;
+    double t2 = stats ? huffman_stats_clock() : 0;
+    huffman_assign_canonical_codes(codes);
+
+    if (stats) {
+        stats->count_seconds += t1 - t0;
+        stats->tree_seconds += t2 - t1;
+        stats->codes_seconds += huffman_stats_clock() - t2;
+        stats->entropy_bits += histogram_entropy(frequencies, size);
+    }
+
+    // Blok z kontekstem wybierany jest według modelu kosztu z options (kompresja, przesłanie
+    // i dekompresja); blok nieskompresowany wygrywa, gdy żaden z kodów nie jest krótszy od oryginału
+    size_t order0_size = HUFFMAN_BLOCK_HEADER_SIZE + length_table_size(codes) + HUFFMAN_JUMP_TABLE_SIZE +
+                         (size_t)((coded_bits(frequencies, codes) + 7) / 8);
+    size_t raw_size = HUFFMAN_BLOCK_HEADER_SIZE + size;
+    if (options->context_tables >= 2) {
+        size_t limit = order0_size < raw_size ? order0_size : raw_size;
+        size_t context_size = encode_context_block(data, size, frequencies, options, limit, out, stats);
+        if (context_size > 0) return context_size;
+    }
+    if (order0_size >= raw_size) return encode_raw_block(data, size, out, stats);
+
+    double t3 = stats ? huffman_stats_clock() : 0;
+
+    // Krótkie bloki nie zyskują na kilku strumieniach, a płacą za tablicę skoków
+    int streams = size >= HUFFMAN_STREAMS_MIN_SIZE;
+    out[0] = streams ? HUFFMAN_BLOCK_STREAMS : HUFFMAN_BLOCK_HUFFMAN;
+    bitstream_store_le32(out + 1, (uint32_t)size);
+    bitstream_store_le32(out + 9, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+
+    size_t pos = HUFFMAN_BLOCK_HEADER_SIZE;
+    pos += write_length_table(out + pos, codes);
+    pos += streams ? encode_streams(data, size, codes, out + pos) : encode_symbols(data, 0, size, codes, out + pos);
+
+    bitstream_store_le32(out + 5, (uint32_t)(pos - HUFFMAN_BLOCK_HEADER_SIZE));
+    if (stats) {
+        stats->coding_seconds += huffman_stats_clock() - t3;
+        stats->code_bits += coded_bits(frequencies, codes);
+        if (longest_code(codes) > stats->max_code_length) stats->max_code_length = longest_code(codes);
+    }
+    return pos;
+}
+
+size_t huffman_message_bound(const HuffmanDictionary* dict, size_t size) {
+    return HUFFMAN_MESSAGE_HEADER_SIZE + (size * (size_t)longest_code(dict->codes) + 7) / 8 + 8;
+}
+
+// Wiadomość kodowana kodami słownika: jeden przebieg po danych, bez histogramu i tablicy kodów.
+// Nagłówek: identyfikator słownika, rozmiar i CRC-32C oryginału (jak w nagłówku bloku)
+size_t huffman_encode_message(const HuffmanDictionary* dict, const unsigned char* data, size_t size, unsigned char* out) {
+    if (size > UINT32_MAX) return 0;
+    bitstream_store_le32(out, dict->id);
+    bitstream_store_le32(out + 4, (uint32_t)size);
+    bitstream_store_le32(out + 8, checksum_crc32c(CHECKSUM_CRC32C_INIT, data, size));
+    return HUFFMAN_MESSAGE_HEADER_SIZE + encode_symbols(data, 0, size, dict->codes, out + HUFFMAN_MESSAGE_HEADER_SIZE);
+}
+
+// Dekoduje jeden symbol: jedno wyszukanie w tablicy (plus podtablice dla długich kodów)
+static inline int decode_symbol(const HuffmanDecodeTable* table, BitReader* br) {
+    bitreader_refill(br);
+    int level_bits = table->root_bits;
+    const HuffmanDecodeEntry* entry = &table->entries[bitreader_peek(br, level_bits)];
+
+    while (entry->kind == HUFFMAN_ENTRY_LINK) {
+        bitreader_consume(br, level_bits);
+        bitreader_refill(br);
+        level_bits = entry->bits;
+        entry = &table->entries[entry->value + bitreader_peek(br, level_bits)];
+    }
+
+    if (entry->kind != HUFFMAN_ENTRY_LEAF) return -1;
+    bitreader_consume(br, entry->bits);
+    return (int)entry->value;
+}
+
+// Dekoduje out[start..end) jedną tablicą; bity poza `available_bits` oznaczają uszkodzony blok
+static int decode_run(const HuffmanDecodeTable* table, BitReader* br, uint64_t available_bits,
+                      unsigned char* out, size_t start, size_t end) {
+    size_t produced = start;
+
+    // Kody ograniczone do tablicy głównej: 4 symbole na jedno uzupełnienie bufora bitów
+    if (table->single_level) {
+        const HuffmanDecodeEntry* entries = table->entries;
+        int root_bits = table->root_bits;
+        while (produced + 4 <= end &&
+               bitreader_position(br) + 4 * (uint64_t)root_bits <= available_bits) {
+            bitreader_refill(br);
+            for (int k = 0; k < 4; k++) {
+                const HuffmanDecodeEntry entry = entries[bitreader_peek(br, root_bits)];
+                bitreader_consume(br, entry.bits);
+                out[produced++] = (unsigned char)entry.value;
+            }
+        }
+    }
+
+    while (produced < end) {
+        int symbol = decode_symbol(table, br);
+        if (symbol < 0 || bitreader_position(br) > available_bits) return 0;
+        out[produced++] = (unsigned char)symbol;
+    }
+    return 1;
+}
+
+// Buduje tablicę dekodującą i zapamiętuje najdłuższy kod bloku (do statystyk)
+static int build_decode_table(HuffmanBlockDecoder* decoder, HuffmanDecodeTable* table, const HuffmanCode codes[]) {
+    if (!huffman_decode_table_build(table, codes)) return 0;
+    int longest = longest_code(codes);
+    if (longest > decoder->max_code_length) decoder->max_code_length = longest;
+    return 1;
+}
+
+static int decode_order0(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder) {
+    HuffmanDecodeTable* table = &decoder->tables[0];
+    HuffmanCode codes[MAX_CHARS];
+    size_t table_size = read_length_table(payload, header->payload_size, codes);
+    if (table_size == 0 || !build_decode_table(decoder, table, codes) || table->count == 0) return 0;
+
+    BitReader br;
+    bitreader_init(&br, payload + table_size, header->payload_size - table_size);
+    return decode_run(table, &br, (uint64_t)(header->payload_size - table_size) * 8, out, 0, header->raw_size);
+}
+
+// Strumienie niezależne: w każdej iteracji 4 symbole z każdego z HUFFMAN_STREAMS strumieni,
+// więc kolejne wyszukiwania w tablicy nie czekają na siebie. Dekoduje out[0..raw_size) z tablicy
+// skoków i strumieni w data[0..size); *consumed to bajty do końca bajtu, na którym skończył się
+// ostatni strumień (początek kolejnego odcinka bloku adaptacyjnego)
+static int decode_stream_set(const HuffmanDecodeTable* table, const unsigned char* data, size_t size,
+                             unsigned char* out, size_t raw_size, size_t* consumed) {
+    if (size < HUFFMAN_JUMP_TABLE_SIZE) return 0;
+
+    size_t stream_sizes[HUFFMAN_STREAMS];
+    size_t used = HUFFMAN_JUMP_TABLE_SIZE;
+    for (int s = 0; s < HUFFMAN_STREAMS - 1; s++) {
+        stream_sizes[s] = bitstream_load_le32(data + 4 * s);
+        if (stream_sizes[s] > size - used) return 0;
+        used += stream_sizes[s];
+    }
+    stream_sizes[HUFFMAN_STREAMS - 1] = size - used;
+
+    BitReader br[HUFFMAN_STREAMS];
+    uint64_t available_bits[HUFFMAN_STREAMS];
+    size_t produced[HUFFMAN_STREAMS], end[HUFFMAN_STREAMS];
+    size_t segment = stream_segment(raw_size);
+    const unsigned char* p = data + HUFFMAN_JUMP_TABLE_SIZE;
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        bitreader_init(&br[s], p, stream_sizes[s]);
+        p += stream_sizes[s];
+        available_bits[s] = (uint64_t)stream_sizes[s] * 8;
+        produced[s] = (size_t)s * segment < raw_size ? (size_t)s * segment : raw_size;
+        end[s] = raw_size - produced[s] > segment ? produced[s] + segment : raw_size;
+    }
+
+    if (table->single_level) {
+        // Lokalne kopie stanu: zapisy przez `out` (unsigned char*) nie zmuszają wtedy kompilatora
+        // do ponownego wczytywania buforów bitów z pamięci
+        BitReader fast[HUFFMAN_STREAMS];
+        unsigned char* dst[HUFFMAN_STREAMS];
+        for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+            fast[s] = br[s];
+            dst[s] = out + produced[s];
+        }
+
+        const HuffmanDecodeEntry* entries = table->entries;
+        int root_bits = table->root_bits;
+        while (1) {
+            int room = 1;
+#pragma GCC unroll 4
+            for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+                room &= dst[s] + 4 <= out + end[s] &&
+                        bitreader_position(&fast[s]) + 4 * (uint64_t)root_bits <= available_bits[s];
+            }
+            if (!room) break;
+
+#pragma GCC unroll 4
+            for (int s = 0; s < HUFFMAN_STREAMS; s++) bitreader_refill(&fast[s]);
+#pragma GCC unroll 4
+            for (int k = 0; k < 4; k++) {
+#pragma GCC unroll 4
+                for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+                    const HuffmanDecodeEntry entry = entries[bitreader_peek(&fast[s], root_bits)];
+                    bitreader_consume(&fast[s], entry.bits);
+                    dst[s][k] = (unsigned char)entry.value;
+                }
+            }
+#pragma GCC unroll 4
+            for (int s = 0; s < HUFFMAN_STREAMS; s++) dst[s] += 4;
+        }
+
+        for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+            br[s] = fast[s];
+            produced[s] = (size_t)(dst[s] - out);
+        }
+    }
+
+    // Końcówki strumieni (ostatni odcinek jest najkrótszy)
+    for (int s = 0; s < HUFFMAN_STREAMS; s++) {
+        if (!decode_run(table, &br[s], available_bits[s], out, produced[s], end[s])) return 0;
+    }
+    *consumed = used + (size_t)((bitreader_position(&br[HUFFMAN_STREAMS - 1]) + 7) / 8);
+    return 1;
+}
+
+static int decode_streams(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder) {
+    HuffmanDecodeTable* table = &decoder->tables[0];
+    HuffmanCode codes[MAX_CHARS];
+    size_t table_size = read_length_table(payload, header->payload_size, codes);
+    if (table_size == 0 || !build_decode_table(decoder, table, codes) || table->count == 0) return 0;
+
+    size_t consumed;
+    return decode_stream_set(table, payload + table_size, header->payload_size - table_size, out, header->raw_size, &consumed);
+}
+
+// Kody kanoniczne wynikają z samych długości, więc równe długości oznaczają tę samą tablicę
+static int same_code_lengths(const HuffmanCode a[], const HuffmanCode b[]) {
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (a[i].length != b[i].length) return 0;
+    }
+    return 1;
+}
+
+// Blok adaptacyjny: te same przebudowy kodów co w koderze, liczone ze zdekodowanych bajtów.
+// Tablica dekodująca budowana jest ponownie tylko wtedy, gdy zmieniły się długości kodów
+static int decode_adaptive(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder) {
+    HuffmanDecodeTable* table = &decoder->tables[0];
+    if (header->payload_size < 5) return 0;
+    int max_len = payload[0];
+    size_t interval = bitstream_load_le32(payload + 1);
+    if (max_len < 1 || max_len > HUFFMAN_MAX_CODE_LEN ||
+        interval < HUFFMAN_MIN_ADAPTIVE_INTERVAL || interval > HUFFMAN_MAX_BLOCK_SIZE) {
+        return 0;
+    }
+
+    uint64_t counts[MAX_CHARS];
+    for (int i = 0; i < MAX_CHARS; i++) counts[i] = 1;
+    HuffmanCode codes[MAX_CHARS], table_codes[MAX_CHARS];
+    if (!adaptive_codes(counts, max_len, codes) || !build_decode_table(decoder, table, codes)) return 0;
+    memcpy(table_codes, codes, sizeof(codes));
+
+    const unsigned char* data = payload + 5;
+    size_t size = header->payload_size - 5, pos = 0;
+    for (size_t start = 0, end; start < header->raw_size; start = end) {
+        end = adaptive_segment(start, header->raw_size, interval);
+        size_t used;
+        if (end - start >= HUFFMAN_STREAMS_MIN_SIZE) {
+            if (!decode_stream_set(table, data + pos, size - pos, out + start, end - start, &used)) return 0;
+        } else {
+            BitReader br;
+            bitreader_init(&br, data + pos, size - pos);
+            if (!decode_run(table, &br, (uint64_t)(size - pos) * 8, out, start, end)) return 0;
+            used = (size_t)((bitreader_position(&br) + 7) / 8);
+        }
+        pos += used;
+        if (end < header->raw_size) {
+            histogram_count(out + start, end - start, counts);
+            if (!adaptive_codes(counts, max_len, codes)) return 0;
+            if (!same_code_lengths(codes, table_codes)) {
+                if (!build_decode_table(decoder, table, codes)) return 0;
+                memcpy(table_codes, codes, sizeof(codes));
+            }
+        }
+    }
+    return pos == size;
+}
+
+// Blok z kontekstem: tablica wybierana przez poprzedni bajt
+static int decode_context(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder) {
+    size_t size = header->payload_size;
+    if (size < 1 + MAX_CHARS / 2) return 0;
+
+    int k = payload[0];
+    if (k < 1 || k > HUFFMAN_MAX_CONTEXTS) return 0;
+
+    const HuffmanDecodeTable* context_tables[MAX_CHARS];
+    for (int c = 0; c < MAX_CHARS; c++) {
+        int j = c % 2 == 0 ? payload[1 + c / 2] >> 4 : payload[1 + c / 2] & 0x0F;
+        if (j >= k) return 0;
+        context_tables[c] = &decoder->tables[j];
+    }
+
+    size_t pos = 1 + MAX_CHARS / 2;
+    size_t table_pos[HUFFMAN_MAX_CONTEXTS];
+    int flat_bits = 0;
+    for (int j = 0; j < k; j++) {
+        HuffmanCode codes[MAX_CHARS];
+        size_t table_size = read_length_table(payload + pos, size - pos, codes);
+        HuffmanDecodeTable* table = &decoder->tables[j];
+        if (table_size == 0 || !build_decode_table(decoder, table, codes) || table->count == 0) return 0;
+        table_pos[j] = pos;
+        pos += table_size;
+        for (int c = 0; c < MAX_CHARS; c++) {
+            if (codes[c].length > flat_bits) flat_bits = codes[c].length;
+        }
+    }
+
+    BitReader br;
+    bitreader_init(&br, payload + pos, size - pos);
+    uint64_t available_bits = (uint64_t)(size - pos) * 8;
+    size_t produced = 0;
+    unsigned prev = 0;
+
+    // Spłaszczona tablica o flat_bits bitach na klaster. Pozycja zawiera jeden albo dwa symbole (drugi,
+    // gdy jego kod w tablicy kontekstu pierwszego mieści się w pozostałych bitach), łączną długość kodów
+    // i numer tablicy kontekstu ostatniego symbolu, więc jedno zależne wyszukiwanie daje zwykle dwa
+    // symbole zamiast wyboru tablicy i przejść przez podtablice na każdy symbol. 16 tablic mieści się
+    // w 32 KB pamięci podręcznej L1. Pozycja zerowa oznacza dłuższy kod (albo uszkodzony strumień),
+    // który dekoduje zwykła tablica klastra. W krótkich blokach wypełnienie tablicy kosztowałoby
+    // więcej niż dekodowanie.
+    if (flat_bits > CONTEXT_FLAT_BITS) flat_bits = CONTEXT_FLAT_BITS;
+    if (((size_t)k << flat_bits) <= header->raw_size) {
+        size_t table_entries = (size_t)1 << flat_bits;
+        if ((size_t)k * table_entries > decoder->context_capacity) {
+            uint32_t* entries = (uint32_t*)realloc(decoder->context_entries, (size_t)k * table_entries * sizeof(uint32_t));
+            if (!entries) return 0;
+            decoder->context_entries = entries;
+            decoder->context_capacity = (size_t)k * table_entries;
+        }
+
+        // Najpierw tablice jednego symbolu: symbol, długość kodu, numer tablicy następnego kontekstu
+        uint16_t single[HUFFMAN_MAX_CONTEXTS << CONTEXT_FLAT_BITS];
+        memset(single, 0, (size_t)k * table_entries * sizeof(uint16_t));
+        for (int j = 0; j < k; j++) {
+            HuffmanCode codes[MAX_CHARS];
+            read_length_table(payload + table_pos[j], size - table_pos[j], codes);
+            uint16_t* entries = single + ((size_t)j << flat_bits);
+            for (int c = 0; c < MAX_CHARS; c++) {
+                int length = codes[c].length;
+                if (length == 0 || length > flat_bits) continue;
+                unsigned next = (unsigned)(context_tables[c] - decoder->tables);
+                uint16_t entry = (uint16_t)(c | length << 8 | next << 12);
+                size_t first = (size_t)(codes[c].bits & (((uint64_t)1 << length) - 1)) << (flat_bits - length);
+                size_t span = (size_t)1 << (flat_bits - length);
+                for (size_t i = first; i < first + span; i++) entries[i] = entry;
+            }
+        }
+
+        // Pary: bity za pierwszym kodem indeksują tablicę jego kontekstu
+        uint32_t* flat = decoder->context_entries;
+        for (size_t i = 0; i < (size_t)k * table_entries; i++) {
+            unsigned first = single[i];
+            if (first == 0) {
+                flat[i] = 0;
+                continue;
+            }
+            unsigned length = (first >> 8) & 0x0F, next = first >> 12;
+            unsigned rest = (unsigned)(i << length) & (unsigned)(table_entries - 1);
+            unsigned second = single[((size_t)next << flat_bits) + rest];
+            unsigned second_length = (second >> 8) & 0x0F;
+            if (second != 0 && length + second_length <= (unsigned)flat_bits) {
+                flat[i] = (first & 0xFF) | (second & 0xFF) << 8 | (length + second_length) << 16 |
+                          (second >> 12) << 20 | 2u << 24;
+            } else {
+                flat[i] = (first & 0xFF) | length << 16 | next << 20 | 1u << 24;
+            }
+        }
+
+        // Do 6 wyszukiwań (po najwyżej flat_bits bitów) na jedno uzupełnienie bufora bitów
+        size_t offset = (size_t)(context_tables[0] - decoder->tables) << flat_bits;
+        while (produced + 12 <= header->raw_size &&
+               bitreader_position(&br) + 6 * (uint64_t)flat_bits <= available_bits) {
+            bitreader_refill(&br);
+            for (int i = 0; i < 6; i++) {
+                uint32_t entry = flat[offset + bitreader_peek(&br, flat_bits)];
+                if (entry == 0) {
+                    int symbol = decode_symbol(&decoder->tables[offset >> flat_bits], &br);
+                    if (symbol < 0 || bitreader_position(&br) > available_bits) return 0;
+                    offset = (size_t)(context_tables[symbol] - decoder->tables) << flat_bits;
+                    out[produced++] = (unsigned char)symbol;
+                    break;
+                }
+                bitreader_consume(&br, (entry >> 16) & 0x0F);
+                offset = (size_t)((entry >> 20) & 0x0F) << flat_bits;
+                out[produced] = (unsigned char)entry;
+                out[produced + 1] = (unsigned char)(entry >> 8);
+                produced += entry >> 24;
+            }
+        }
+        if (produced > 0) prev = out[produced - 1];
+    }
+
+    while (produced < header->raw_size) {
+        int symbol = decode_symbol(context_tables[prev], &br);
+        if (symbol < 0 || bitreader_position(&br) > available_bits) return 0;
+        prev = (unsigned)symbol;
+        out[produced++] = (unsigned char)symbol;
+    }
+    return 1;
+}
+
+int huffman_decode_block(const HuffmanBlockHeader* header, const unsigned char* payload, unsigned char* out, HuffmanBlockDecoder* decoder) {
+    HuffmanStats* stats = decoder->stats;
+    double start = stats ? huffman_stats_clock() : 0;
+    int ok = 1;
+    decoder->max_code_length = 0;
+    if (header->type == HUFFMAN_BLOCK_RAW) {
+        memcpy(out, payload, header->raw_size);
+    } else if (header->type == HUFFMAN_BLOCK_RLE) {
+        memset(out, payload[0], header->raw_size);
+    } else if (header->type == HUFFMAN_BLOCK_CONTEXT) {
+        ok = decode_context(header, payload, out, decoder);
+    } else if (header->type == HUFFMAN_BLOCK_STREAMS) {
+        ok = decode_streams(header, payload, out, decoder);
+    } else if (header->type == HUFFMAN_BLOCK_ADAPTIVE) {
+        ok = decode_adaptive(header, payload, out, decoder);
+    } else {
+        ok = decode_order0(header, payload, out, decoder);
+    }
+    ok = ok && checksum_crc32c(CHECKSUM_CRC32C_INIT, out, header->raw_size) == header->checksum;
+
+    // Czas budowy tablic nie jest wydzielany: zawiera się w czasie dekodowania bloku
+    if (stats && ok) {
+        stats->coding_seconds += huffman_stats_clock() - start;
+        stats->blocks++;
+        stats->symbols += header->raw_size;
+        stats->code_bits += (uint64_t)header->payload_size * 8;
+        if (decoder->max_code_length > stats->max_code_length) stats->max_code_length = decoder->max_code_length;
+    }
+    return ok;
+}
+
+// Identyfikator słownika wiadomości (0, gdy wiadomość jest za krótka); pozwala wybrać słownik przed dekodowaniem
+uint32_t huffman_message_dictionary_id(const unsigned char* in, size_t in_size) {
+    return in_size >= HUFFMAN_MESSAGE_HEADER_SIZE ? bitstream_load_le32(in) : 0;
+}
+
+int huffman_decode_message(const HuffmanDictionary* dict, const unsigned char* in, size_t in_size,
+                           unsigned char* out, size_t out_capacity, size_t* out_size) {
+    if (in_size < HUFFMAN_MESSAGE_HEADER_SIZE || bitstream_load_le32(in) != dict->id) return 0;
+    size_t size = bitstream_load_le32(in + 4);
+    if (size > out_capacity) return 0;
+
+    BitReader br;
+    bitreader_init(&br, in + HUFFMAN_MESSAGE_HEADER_SIZE, in_size - HUFFMAN_MESSAGE_HEADER_SIZE);
+    if (!decode_run(&dict->table, &br, (uint64_t)(in_size - HUFFMAN_MESSAGE_HEADER_SIZE) * 8, out, 0, size)) return 0;
+    if (checksum_crc32c(CHECKSUM_CRC32C_INIT, out, size) != bitstream_load_le32(in + 8)) return 0;
+    *out_size = size;
+    return 1;
+}
+
+void huffman_block_decoder_init(HuffmanBlockDecoder* decoder) {
+    for (int j = 0; j < HUFFMAN_MAX_CONTEXTS; j++) {
+        huffman_decode_table_init(&decoder->tables[j]);
+    }
+    decoder->context_entries = NULL;
+    decoder->context_capacity = 0;
+    decoder->max_code_length = 0;
+    decoder->stats = NULL;
+}
+
+void huffman_block_decoder_free(HuffmanBlockDecoder* decoder) {
+    for (int j = 0; j < HUFFMAN_MAX_CONTEXTS; j++) {
+        huffman_decode_table_free(&decoder->tables[j]);
+    }
+    free(decoder->context_entries);
+    decoder->context_entries = NULL;
+    decoder->context_capacity = 0;
+}
@@ -0,0 +1,225 @@
+#include "huffman.h"
+#include "bitstream.h"
+#include "checksum.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Kody słownika z histogramu próbek. Każdy bajt dostaje licznik co najmniej 1, więc da się
+// zakodować także symbol nieobecny w próbkach (kosztem dłuższego kodu).
+// Identyfikator 0 oznacza identyfikator wyliczony z długości kodów (CRC-32C).
+int huffman_dictionary_train(HuffmanDictionary* dict, uint32_t id, const uint64_t frequencies[], int max_code_length) {
+    if (max_code_length < 8 || max_code_length > HUFFMAN_MAX_CODE_LEN) return 0;
+
+    uint64_t counts[MAX_CHARS];
+    for (int i = 0; i < MAX_CHARS; i++) {
+        counts[i] = frequencies[i] + 1;
+    }
+    huffman_code_lengths(counts, dict->codes);
+    if (!huffman_limit_code_lengths(counts, dict->codes, max_code_length)) return 0;
+    huffman_assign_canonical_codes(dict->codes);
+
+    if (id == 0) {
+        unsigned char lengths[MAX_CHARS];
+        for (int i = 0; i < MAX_CHARS; i++) lengths[i] = dict->codes[i].length;
+        id = checksum_crc32c(CHECKSUM_CRC32C_INIT, lengths, MAX_CHARS);
+        if (id == 0) id = 1;
+    }
+    dict->id = id;
+
+    huffman_decode_table_init(&dict->table);
+    if (!huffman_decode_table_build(&dict->table, dict->codes)) {
+        huffman_decode_table_free(&dict->table);
+        return 0;
+    }
+    return 1;
+}
+
+int huffman_dictionary_save(const HuffmanDictionary* dict, const char* filename) {
+    unsigned char buf[HUFFMAN_DICT_FILE_SIZE] = {0};
+    memcpy(buf, HUFFMAN_DICT_MAGIC, 4);
+    buf[4] = HUFFMAN_DICT_VERSION;
+    bitstream_store_le32(buf + 8, dict->id);
+    for (int i = 0; i < MAX_CHARS; i++) {
+        buf[12 + i] = dict->codes[i].length;
+    }
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) return 0;
+    int ok = fwrite(buf, 1, sizeof(buf), file) == sizeof(buf);
+    return fclose(file) == 0 && ok;
+}
+
+int huffman_dictionary_load(HuffmanDictionary* dict, const char* filename) {
+    unsigned char buf[HUFFMAN_DICT_FILE_SIZE];
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    int ok = fread(buf, 1, sizeof(buf), file) == sizeof(buf);
+    fclose(file);
+    if (!ok || memcmp(buf, HUFFMAN_DICT_MAGIC, 4) != 0 || buf[4] != HUFFMAN_DICT_VERSION) return 0;
+
+    // Długości muszą opisywać pełny kod prefiksowy obejmujący wszystkie bajty (suma Krafta równa 1)
+    uint64_t kraft = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        int length = buf[12 + i];
+        if (length < 1 || length > HUFFMAN_MAX_CODE_LEN) return 0;
+        dict->codes[i].length = (uint8_t)length;
+        kraft += (uint64_t)1 << (HUFFMAN_MAX_CODE_LEN - length);
+    }
+    if (kraft != (uint64_t)1 << HUFFMAN_MAX_CODE_LEN) return 0;
+    huffman_assign_canonical_codes(dict->codes);
+    dict->id = bitstream_load_le32(buf + 8);
+
+    huffman_decode_table_init(&dict->table);
+    if (!huffman_decode_table_build(&dict->table, dict->codes)) {
+        huffman_decode_table_free(&dict->table);
+        return 0;
+    }
+    return 1;
+}
+
+void huffman_dictionary_free(HuffmanDictionary* dict) {
+    huffman_decode_table_free(&dict->table);
+}
+
+// Wczytuje cały plik (wiadomości są krótkie); zwraca 0, gdy pliku nie da się odczytać
+static int read_whole_file(const char* filename, unsigned char** data, size_t* size) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+
+    size_t capacity = 4096, used = 0;
+    unsigned char* buf = (unsigned char*)malloc(capacity);
+    while (buf) {
+        used += fread(buf + used, 1, capacity - used, file);
+        if (used < capacity) break;
+        unsigned char* grown = (unsigned char*)realloc(buf, capacity * 2);
+        if (!grown) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = grown;
+        capacity *= 2;
+    }
+    int ok = buf != NULL && !ferror(file);
+    fclose(file);
+    if (!ok) {
+        free(buf);
+        return 0;
+    }
+    *data = buf;
+    *size = used;
+    return 1;
+}
+
+static int longest_dictionary_code(const HuffmanDictionary* dict) {
+    int longest = 0;
+    for (int i = 0; i < MAX_CHARS; i++) {
+        if (dict->codes[i].length > longest) longest = dict->codes[i].length;
+    }
+    return longest;
+}
+
+static int write_whole_file(const char* filename, const unsigned char* data, size_t size) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return 0;
+    int ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+// Plik kodowany jako jedna wiadomość słownikiem options->dictionary (huffman -c -D słownik)
+int huffman_compress_message_file(const char* input_file, const char* output_file, const HuffmanOptions* options) {
+    const HuffmanDictionary* dict = options->dictionary;
+    double start = huffman_stats_wall_clock();
+    double t0 = huffman_stats_clock();
+    unsigned char* data = NULL;
+    size_t size = 0;
+    if (!read_whole_file(input_file, &data, &size)) {
+        printf("Błąd: Nie udało się otworzyć plików!\n");
+        return 0;
+    }
+    if (size > UINT32_MAX) {
+        printf("Błąd: Wiadomość może mieć najwyżej %u bajtów!\n", UINT32_MAX);
+        free(data);
+        return 0;
+    }
+
+    double t1 = huffman_stats_clock();
+    unsigned char* packed = (unsigned char*)malloc(huffman_message_bound(dict, size));
+    size_t packed_size = packed ? huffman_encode_message(dict, data, size, packed) : 0;
+    double t2 = huffman_stats_clock();
+    int ok = packed_size > 0 && write_whole_file(output_file, packed, packed_size);
+    double t3 = huffman_stats_clock();
+    free(data);
+    free(packed);
+    if (!ok) {
+        printf("Błąd: Nie udało się zapisać wiadomości!\n");
+        return 0;
+    }
+
+    if (options->stats) {
+        huffman_stats_reset(options->stats);
+        options->stats->io_seconds = (t1 - t0) + (t3 - t2);
+        options->stats->coding_seconds = t2 - t1;
+        options->stats->bytes_in = size;
+        options->stats->bytes_out = packed_size;
+        options->stats->symbols = size;
+        options->stats->code_bits = (uint64_t)(packed_size - HUFFMAN_MESSAGE_HEADER_SIZE) * 8;
+        options->stats->max_code_length = longest_dictionary_code(dict);
+        options->stats->total_seconds = huffman_stats_wall_clock() - start;
+    }
+    if (!options->quiet) printf("Kompresja zakończona pomyślnie!\n");
+    return 1;
+}
+
+// Dekoduje wiadomość z pliku słownikiem options->dictionary; bez pliku wyjściowego tylko sprawdza
+// identyfikator słownika i sumę kontrolną (huffman --verify -D słownik)
+int huffman_decompress_message_file(const char* input_file, const char* output_file, const HuffmanOptions* options) {
+    const HuffmanDictionary* dict = options->dictionary;
+    double start = huffman_stats_wall_clock();
+    double t0 = huffman_stats_clock();
+    unsigned char* packed = NULL;
+    size_t packed_size = 0;
+    if (!read_whole_file(input_file, &packed, &packed_size)) {
+        printf("Błąd: Nie udało się otworzyć plików!\n");
+        return 0;
+    }
+    if (packed_size >= HUFFMAN_MESSAGE_HEADER_SIZE && huffman_message_dictionary_id(packed, packed_size) != dict->id) {
+        printf("Błąd: Wiadomość zakodowano innym słownikiem (id 0x%08x)!\n", huffman_message_dictionary_id(packed, packed_size));
+        free(packed);
+        return 0;
+    }
+
+    double t1 = huffman_stats_clock();
+    // Każdy symbol zajmuje co najmniej bit, więc większy rozmiar z nagłówka oznacza uszkodzenie
+    size_t capacity = packed_size >= HUFFMAN_MESSAGE_HEADER_SIZE ? bitstream_load_le32(packed + 4) : 0;
+    if (capacity > (packed_size - HUFFMAN_MESSAGE_HEADER_SIZE) * 8) capacity = 0;
+    unsigned char* data = (unsigned char*)malloc(capacity > 0 ? capacity : 1);
+    size_t size = 0;
+    int ok = data != NULL && huffman_decode_message(dict, packed, packed_size, data, capacity, &size);
+    double t2 = huffman_stats_clock();
+    if (!ok) {
+        printf("Błąd: Uszkodzone dane skompresowane!\n");
+    } else if (output_file && !write_whole_file(output_file, data, size)) {
+        printf("Błąd: Nie udało się zapisać pliku!\n");
+        ok = 0;
+    }
+    double t3 = huffman_stats_clock();
+    free(packed);
+    free(data);
+    if (!ok) return 0;
+
+    if (options->stats) {
+        huffman_stats_reset(options->stats);
+        options->stats->io_seconds = (t1 - t0) + (t3 - t2);
+        options->stats->coding_seconds = t2 - t1;
+        options->stats->bytes_in = packed_size;
+        options->stats->bytes_out = size;
+        options->stats->symbols = size;
+        options->stats->code_bits = (uint64_t)(packed_size - HUFFMAN_MESSAGE_HEADER_SIZE) * 8;
+        options->stats->max_code_length = longest_dictionary_code(dict);
+        options->stats->total_seconds = huffman_stats_wall_clock() - start;
+    }
+    if (!options->quiet) printf(output_file ? "Dekompresja zakończona pomyślnie!\n" : "Weryfikacja zakończona pomyślnie!\n");
+    return 1;
+}
@@ -0,0 +1,380 @@
+#include "huffman.h"
+#include "bitstream.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bufor bajtów czekających na przekazanie wywołującemu
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t pos;
+    size_t capacity;
+} PendingBuffer;
+
+static unsigned char* pending_reserve(PendingBuffer* pending, size_t n) {
+    if (pending->pos == pending->size) {
+        pending->pos = 0;
+        pending->size = 0;
+    }
+    if (pending->size + n > pending->capacity) {
+        size_t new_capacity = pending->capacity ? pending->capacity : 4096;
+        while (new_capacity < pending->size + n) new_capacity *= 2;
+        unsigned char* data = (unsigned char*)realloc(pending->data, new_capacity);
+        if (!data) return NULL;
+        pending->data = data;
+        pending->capacity = new_capacity;
+    }
+    return pending->data + pending->size;
+}
+
+static void pending_drain(PendingBuffer* pending, unsigned char* out, size_t out_capacity, size_t* out_produced) {
+    size_t n = pending->size - pending->pos;
+    if (n > out_capacity - *out_produced) n = out_capacity - *out_produced;
+    memcpy(out + *out_produced, pending->data + pending->pos, n);
+    pending->pos += n;
+    *out_produced += n;
+}
+
+static int pending_empty(const PendingBuffer* pending) {
+    return pending->pos == pending->size;
+}
+
+struct HuffmanEncoder {
+    HuffmanOptions options;
+    unsigned char* block;
+    size_t block_fill;
+    PendingBuffer pending;
+
+    uint64_t stream_offset;       // Bajty wyprodukowane od początku strumienia
+    uint64_t original_size;
+    uint64_t* block_offsets;
+    uint32_t* block_sizes;
+    size_t block_count;
+    size_t index_capacity;
+    int finished;
+};
+
+HuffmanEncoder* huffman_encoder_create(const HuffmanOptions* options) {
+    HuffmanOptions defaults;
+    if (!options) {
+        huffman_default_options(&defaults);
+        options = &defaults;
+    }
+    if (options->max_code_length < 1 || options->max_code_length > HUFFMAN_MAX_CODE_LEN ||
+        options->block_size < HUFFMAN_MIN_BLOCK_SIZE || options->block_size > HUFFMAN_MAX_BLOCK_SIZE ||
+        (options->context_tables != 0 && (options->context_tables < 2 || options->context_tables > HUFFMAN_MAX_CONTEXTS)) ||
+        (options->adaptive_interval != 0 &&
+         (options->adaptive_interval < HUFFMAN_MIN_ADAPTIVE_INTERVAL || options->adaptive_interval > HUFFMAN_MAX_BLOCK_SIZE))) {
+        return NULL;
+    }
+
+    HuffmanEncoder* encoder = (HuffmanEncoder*)calloc(1, sizeof(HuffmanEncoder));
+    if (!encoder) return NULL;
+    encoder->options = *options;
+    encoder->block = (unsigned char*)malloc(options->block_size);
+
+    unsigned char* header = pending_reserve(&encoder->pending, HUFFMAN_FILE_HEADER_SIZE);
+    if (!encoder->block || !header) {
+        huffman_encoder_destroy(encoder);
+        return NULL;
+    }
+    huffman_write_file_header(header, (uint32_t)options->block_size);
+    encoder->pending.size += HUFFMAN_FILE_HEADER_SIZE;
+    encoder->stream_offset = HUFFMAN_FILE_HEADER_SIZE;
+    return encoder;
+}
+
+void huffman_encoder_destroy(HuffmanEncoder* encoder) {
+    if (!encoder) return;
+    free(encoder->block);
+    free(encoder->pending.data);
+    free(encoder->block_offsets);
+    free(encoder->block_sizes);
+    free(encoder);
+}
+
+// Koduje zebrany blok na koniec bufora oczekującego i dopisuje go do indeksu
+static int encoder_flush_block(HuffmanEncoder* encoder) {
+    if (encoder->block_count == encoder->index_capacity) {
+        size_t new_capacity = encoder->index_capacity ? encoder->index_capacity * 2 : 64;
+        uint64_t* offsets = (uint64_t*)realloc(encoder->block_offsets, new_capacity * sizeof(uint64_t));
+        if (!offsets) return 0;
+        encoder->block_offsets = offsets;
+        uint32_t* sizes = (uint32_t*)realloc(encoder->block_sizes, new_capacity * sizeof(uint32_t));
+        if (!sizes) return 0;
+        encoder->block_sizes = sizes;
+        encoder->index_capacity = new_capacity;
+    }
+
+    unsigned char* out = pending_reserve(&encoder->pending, huffman_block_bound(encoder->block_fill, &encoder->options));
+    if (!out) return 0;
+
+    size_t size = huffman_encode_block(encoder->block, encoder->block_fill, &encoder->options, out,
+                                       encoder->options.stats);
+    if (size == 0) return 0;
+
+    encoder->block_offsets[encoder->block_count] = encoder->stream_offset;
+    encoder->block_sizes[encoder->block_count] = (uint32_t)encoder->block_fill;
+    encoder->block_count++;
+    encoder->pending.size += size;
+    encoder->stream_offset += size;
+    encoder->original_size += encoder->block_fill;
+    encoder->block_fill = 0;
+    return 1;
+}
+
+int huffman_encoder_update(HuffmanEncoder* encoder, const unsigned char* in, size_t in_size, size_t* in_consumed,
+                           unsigned char* out, size_t out_capacity, size_t* out_produced) {
+    *in_consumed = 0;
+    *out_produced = 0;
+    if (!encoder || encoder->finished) return HUFFMAN_STREAM_ERROR;
+
+    while (1) {
+        pending_drain(&encoder->pending, out, out_capacity, out_produced);
+        if (!pending_empty(&encoder->pending) || *in_consumed == in_size) break;
+
+        size_t n = encoder->options.block_size - encoder->block_fill;
+        if (n > in_size - *in_consumed) n = in_size - *in_consumed;
+        memcpy(encoder->block + encoder->block_fill, in + *in_consumed, n);
+        encoder->block_fill += n;
+        *in_consumed += n;
+
+        if (encoder->block_fill == encoder->options.block_size && !encoder_flush_block(encoder)) {
+            return HUFFMAN_STREAM_ERROR;
+        }
+    }
+
+    return *in_consumed == in_size ? HUFFMAN_STREAM_DONE : HUFFMAN_STREAM_MORE;
+}
+
+int huffman_encoder_flush(HuffmanEncoder* encoder, unsigned char* out, size_t out_capacity, size_t* out_produced) {
+    *out_produced = 0;
+    if (!encoder || encoder->finished) return HUFFMAN_STREAM_ERROR;
+
+    if (encoder->block_fill > 0 && !encoder_flush_block(encoder)) return HUFFMAN_STREAM_ERROR;
+    pending_drain(&encoder->pending, out, out_capacity, out_produced);
+    return pending_empty(&encoder->pending) ? HUFFMAN_STREAM_DONE : HUFFMAN_STREAM_MORE;
+}
+
+int huffman_encoder_finish(HuffmanEncoder* encoder, unsigned char* out, size_t out_capacity, size_t* out_produced) {
+    *out_produced = 0;
+    if (!encoder) return HUFFMAN_STREAM_ERROR;
+
+    if (!encoder->finished) {
+        if (encoder->block_fill > 0 && !encoder_flush_block(encoder)) return HUFFMAN_STREAM_ERROR;
+
+        // Znacznik końca, indeks bloków i stopka
+        size_t tail_size = 1 + 4 + encoder->block_count * HUFFMAN_INDEX_ENTRY_SIZE + HUFFMAN_TRAILER_SIZE;
+        unsigned char* p = pending_reserve(&encoder->pending, tail_size);
+        if (!p) return HUFFMAN_STREAM_ERROR;
+
+        *p++ = HUFFMAN_BLOCK_END;
+        bitstream_store_le32(p, (uint32_t)encoder->block_count);
+        p += 4;
+        for (size_t i = 0; i < encoder->block_count; i++) {
+            bitstream_store_le64(p, encoder->block_offsets[i]);
+            bitstream_store_le32(p + 8, encoder->block_sizes[i]);
+            p += HUFFMAN_INDEX_ENTRY_SIZE;
+        }
+        bitstream_store_le64(p, encoder->stream_offset + 1);
+        bitstream_store_le64(p + 8, encoder->original_size);
+        memcpy(p + 16, HUFFMAN_TRAILER_MAGIC, 4);
+
+        encoder->pending.size += tail_size;
+        encoder->stream_offset += tail_size;
+        encoder->finished = 1;
+    }
+
+    pending_drain(&encoder->pending, out, out_capacity, out_produced);
+    return pending_empty(&encoder->pending) ? HUFFMAN_STREAM_DONE : HUFFMAN_STREAM_MORE;
+}
+
+// Etapy dekodera strumieniowego
+enum {
+    STAGE_FILE_HEADER,
+    STAGE_BLOCK_TYPE,
+    STAGE_BLOCK_HEADER,
+    STAGE_PAYLOAD,
+    STAGE_FLUSH,
+    STAGE_INDEX_COUNT,
+    STAGE_INDEX_ENTRY,
+    STAGE_TRAILER,
+    STAGE_DONE
+};
+
+struct HuffmanDecoder {
+    int stage;
+    unsigned char* buf;           // Bajty zbierane dla bieżącego etapu
+    size_t buf_capacity;
+    size_t have;
+    size_t need;
+
+    uint32_t block_size;
+    HuffmanBlockHeader block_header;
+    HuffmanBlockDecoder block_decoder;
+    unsigned char* block;         // Zdekodowany blok czekający na przekazanie
+    size_t block_pos;
+
+    uint32_t blocks;
+    uint32_t index_remaining;
+    uint64_t original_size;
+    uint64_t stream_offset;       // Położenie bieżącego nagłówka bloku (albo znacznika końca) w strumieniu
+    HuffmanIndexCheck index_check;
+};
+
+static int decoder_expect(HuffmanDecoder* decoder, int stage, size_t need) {
+    if (need > decoder->buf_capacity) {
+        unsigned char* buf = (unsigned char*)realloc(decoder->buf, need);
+        if (!buf) return 0;
+        decoder->buf = buf;
+        decoder->buf_capacity = need;
+    }
+    decoder->stage = stage;
+    decoder->have = 0;
+    decoder->need = need;
+    return 1;
+}
+
+HuffmanDecoder* huffman_decoder_create(void) {
+    HuffmanDecoder* decoder = (HuffmanDecoder*)calloc(1, sizeof(HuffmanDecoder));
+    if (!decoder) return NULL;
+    huffman_block_decoder_init(&decoder->block_decoder);
+    if (!decoder_expect(decoder, STAGE_FILE_HEADER, HUFFMAN_FILE_HEADER_SIZE)) {
+        huffman_decoder_destroy(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+void huffman_decoder_destroy(HuffmanDecoder* decoder) {
+    if (!decoder) return;
+    free(decoder->buf);
+    free(decoder->block);
+    huffman_block_decoder_free(&decoder->block_decoder);
+    free(decoder);
+}
+
+// Przetwarza komplet bajtów zebranych dla bieżącego etapu
+static int decoder_advance(HuffmanDecoder* decoder) {
+    const unsigned char* p = decoder->buf;
+
+    switch (decoder->stage) {
+    case STAGE_FILE_HEADER:
+        if (!huffman_parse_file_header(p, &decoder->block_size)) return 0;
+        decoder->stream_offset = HUFFMAN_FILE_HEADER_SIZE;
+        decoder->block = (unsigned char*)malloc(decoder->block_size);
+        return decoder->block && decoder_expect(decoder, STAGE_BLOCK_TYPE, 1);
+
+    case STAGE_BLOCK_TYPE: {
+        unsigned char type = p[0];
+        if (type == HUFFMAN_BLOCK_END) {
+            huffman_index_check_init(&decoder->index_check, decoder->block_size, decoder->stream_offset);
+            return decoder_expect(decoder, STAGE_INDEX_COUNT, 4);
+        }
+        if (!decoder_expect(decoder, STAGE_BLOCK_HEADER, HUFFMAN_BLOCK_HEADER_SIZE)) return 0;
+        decoder->buf[0] = type;
+        decoder->have = 1;
+        return 1;
+    }
+
+    case STAGE_BLOCK_HEADER:
+        if (!huffman_read_block_header(p, &decoder->block_header) ||
+            decoder->block_header.raw_size > decoder->block_size) {
+            return 0;
+        }
+        return decoder_expect(decoder, STAGE_PAYLOAD, decoder->block_header.payload_size);
+
+    case STAGE_PAYLOAD:
+        if (!huffman_decode_block(&decoder->block_header, p, decoder->block, &decoder->block_decoder)) return 0;
+        decoder->blocks++;
+        decoder->original_size += decoder->block_header.raw_size;
+        decoder->stream_offset += HUFFMAN_BLOCK_HEADER_SIZE + decoder->block_header.payload_size;
+        decoder->block_pos = 0;
+        decoder->stage = STAGE_FLUSH;
+        return 1;
+
+    case STAGE_INDEX_COUNT:
+        decoder->index_remaining = bitstream_load_le32(p);
+        if (decoder->index_remaining != decoder->blocks) return 0;
+        return decoder->index_remaining > 0 ? decoder_expect(decoder, STAGE_INDEX_ENTRY, HUFFMAN_INDEX_ENTRY_SIZE)
+                                            : decoder_expect(decoder, STAGE_TRAILER, HUFFMAN_TRAILER_SIZE);
+
+    case STAGE_INDEX_ENTRY:
+        if (!huffman_index_check_entry(&decoder->index_check, p, NULL, NULL)) return 0;
+        if (--decoder->index_remaining > 0) return decoder_expect(decoder, STAGE_INDEX_ENTRY, HUFFMAN_INDEX_ENTRY_SIZE);
+        return decoder_expect(decoder, STAGE_TRAILER, HUFFMAN_TRAILER_SIZE);
+
+    case STAGE_TRAILER:
+        if (!huffman_index_check_trailer(&decoder->index_check, p, decoder->original_size)) return 0;
+        decoder->stage = STAGE_DONE;
+        return 1;
+    }
+    return 0;
+}
+
+int huffman_decoder_update(HuffmanDecoder* decoder, const unsigned char* in, size_t in_size, size_t* in_consumed,
+                           unsigned char* out, size_t out_capacity, size_t* out_produced) {
+    *in_consumed = 0;
+    *out_produced = 0;
+    if (!decoder) return HUFFMAN_STREAM_ERROR;
+
+    while (decoder->stage != STAGE_DONE) {
+        if (decoder->stage == STAGE_FLUSH) {
+            size_t n = decoder->block_header.raw_size - decoder->block_pos;
+            if (n > out_capacity - *out_produced) n = out_capacity - *out_produced;
+            memcpy(out + *out_produced, decoder->block + decoder->block_pos, n);
+            decoder->block_pos += n;
+            *out_produced += n;
+            if (decoder->block_pos < decoder->block_header.raw_size) return HUFFMAN_STREAM_MORE;
+            if (!decoder_expect(decoder, STAGE_BLOCK_TYPE, 1)) return HUFFMAN_STREAM_ERROR;
+            continue;
+        }
+
+        size_t n = decoder->need - decoder->have;
+        if (n > in_size - *in_consumed) n = in_size - *in_consumed;
+        memcpy(decoder->buf + decoder->have, in + *in_consumed, n);
+        decoder->have += n;
+        *in_consumed += n;
+        if (decoder->have < decoder->need) return HUFFMAN_STREAM_MORE;
+
+        if (!decoder_advance(decoder)) return HUFFMAN_STREAM_ERROR;
+    }
+
+    return HUFFMAN_STREAM_DONE;
+}
+
+size_t huffman_compress_bound(size_t size, const HuffmanOptions* options) {
+    size_t blocks = size / options->block_size + 1;
+    return HUFFMAN_FILE_HEADER_SIZE + blocks * (huffman_block_bound(options->block_size, options) + HUFFMAN_INDEX_ENTRY_SIZE) +
+           1 + 4 + HUFFMAN_TRAILER_SIZE;
+}
+
+int huffman_compress_buffer(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_capacity,
+                            size_t* out_size, const HuffmanOptions* options) {
+    HuffmanEncoder* encoder = huffman_encoder_create(options);
+    if (!encoder) return 0;
+
+    size_t consumed, produced, total = 0;
+    int status = huffman_encoder_update(encoder, in, in_size, &consumed, out, out_capacity, &produced);
+    total += produced;
+    if (status == HUFFMAN_STREAM_DONE) {
+        status = huffman_encoder_finish(encoder, out + total, out_capacity - total, &produced);
+        total += produced;
+    }
+    huffman_encoder_destroy(encoder);
+
+    *out_size = total;
+    return status == HUFFMAN_STREAM_DONE;
+}
+
+int huffman_decompress_buffer(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_capacity,
+                              size_t* out_size) {
+    HuffmanDecoder* decoder = huffman_decoder_create();
+    if (!decoder) return 0;
+
+    // Bufor zawiera dokładnie jeden plik: bajty za stopką oznaczają uszkodzone dane
+    size_t consumed;
+    int status = huffman_decoder_update(decoder, in, in_size, &consumed, out, out_capacity, out_size);
+    huffman_decoder_destroy(decoder);
+    return status == HUFFMAN_STREAM_DONE && consumed == in_size;
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 #include "priority_queue.h"
 #include "huffman.h"
+#include "batch.h"
 
 void print_int(void* data) {
     if (data) {
@@ -27,6 +28,7 @@ void test_priority_queue() {
 
     int choice;
     int* data_array[100];
+    PQHandle handles[100];
     int data_count = 0;
 
     while (1) {
@@ -47,8 +49,10 @@ void test_priority_queue() {
             scanf("%d", value);
             printf("Podaj priorytet: ");
             scanf("%d", &priority);
-            if (pq_add(pq, value, priority)) {
+            PQHandle handle = pq_add(pq, value, priority);
+            if (handle != PQ_INVALID_HANDLE) {
                 printf("Element dodany pomyślnie!\n");
+                handles[data_count] = handle;
                 data_array[data_count++] = value;
             } else {
                 printf("Błąd podczas dodawania elementu!\n");
@@ -59,6 +63,9 @@ void test_priority_queue() {
             int* removed = (int*)pq_remove(pq);
             if (removed) {
                 printf("Usunięto element: %d\n", *removed);
+                for (int i = 0; i < data_count; i++) {
+                    if (data_array[i] == removed) data_array[i] = NULL;
+                }
                 free(removed);
             } else {
                 printf("Kolejka jest pusta!\n");
@@ -71,15 +78,15 @@ void test_priority_queue() {
             printf("Podaj nowy priorytet (mniejszy): ");
             scanf("%d", &new_priority);
             
-            int* found = NULL;
+            PQHandle found = PQ_INVALID_HANDLE;
             for (int i = 0; i < data_count; i++) {
                 if (data_array[i] && *(data_array[i]) == value) {
-                    found = data_array[i];
+                    found = handles[i];
                     break;
                 }
             }
             
-            if (found && pq_decrease_priority(pq, found, new_priority)) {
+            if (pq_decrease_priority(pq, found, new_priority)) {
                 printf("Priorytet zmniejszony pomyślnie!\n");
             } else {
                 printf("Błąd: Nie znaleziono elementu lub nowy priorytet nie jest mniejszy!\n");
@@ -92,15 +99,15 @@ void test_priority_queue() {
             printf("Podaj nowy priorytet: ");
             scanf("%d", &new_priority);
             
-            int* found = NULL;
+            PQHandle found = PQ_INVALID_HANDLE;
             for (int i = 0; i < data_count; i++) {
                 if (data_array[i] && *(data_array[i]) == value) {
-                    found = data_array[i];
+                    found = handles[i];
                     break;
                 }
             }
             
-            if (found && pq_set_priority(pq, found, new_priority)) {
+            if (pq_set_priority(pq, found, new_priority)) {
                 printf("Priorytet ustawiony pomyślnie!\n");
             } else {
                 printf("Błąd: Nie znaleziono elementu!\n");
@@ -127,15 +134,13 @@ void test_priority_queue() {
                     int* ptr = (int*)pq_remove(pq);
                     free(ptr);
                 }
-                for (int i = 0; i < data_count; i++) {
-                    if (data_array[i]) free(data_array[i]);
-                }
                 pq_destroy(pq);
 
                 pq = pq_build(data, priorities, count);
                 data_count = count;
                 for (int i = 0; i < count; i++) {
                     data_array[i] = (int*)data[i];
+                    handles[i] = (PQHandle)(i + 1);
                 }
                 
                 if (pq) {
@@ -162,13 +167,141 @@ void test_priority_queue() {
         int* ptr = (int*)pq_remove(pq);
         free(ptr);
     }
-    for (int i = 0; i < data_count; i++) {
-        if (data_array[i]) free(data_array[i]);
-    }
     pq_destroy(pq);
 }
 
-int main() {
+static void print_usage(void) {
+    printf("Użycie: huffman               (menu)\n");
+    printf("        huffman -c [-f] [-j N] [-b rozmiar_bloku] [-D słownik] [--stats] pliki...\n");
+    printf("        huffman -d [-f] [-j N] [-D słownik] [--stats] pliki%s...\n", BATCH_EXTENSION);
+    printf("        huffman --verify [-j N] [-D słownik] [--stats] pliki%s...\n", BATCH_EXTENSION);
+    printf("        huffman --train słownik [-l maks_długość_kodu] [-i id] próbki...\n");
+}
+
+// Tryb wsadowy: huffman -c|-d|--verify [-f] [-j N] [-b rozmiar_bloku] [-D słownik] [--stats] pliki...
+// Ze słownikiem każdy plik jest jedną wiadomością (bez histogramu i tablicy kodów)
+static int run_batch(int argc, char* argv[]) {
+    HuffmanOptions options;
+    HuffmanStats stats;
+    HuffmanDictionary dict;
+    const char* dictionary_file = NULL;
+    huffman_default_options(&options);
+    int mode = -1, jobs = 0, force = 0;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            mode = BATCH_COMPRESS;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            mode = BATCH_DECOMPRESS;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            mode = BATCH_VERIFY;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            force = 1;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char* value = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            jobs = atoi(value);
+            if (jobs <= 0) {
+                printf("Błąd: Nieprawidłowa liczba wątków!\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            options.block_size = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc) {
+            dictionary_file = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options.stats = &stats;
+        } else if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (mode < 0 || i == argc) {
+        print_usage();
+        return 1;
+    }
+    if (dictionary_file) {
+        if (!huffman_dictionary_load(&dict, dictionary_file)) {
+            printf("Błąd: Nie udało się wczytać słownika %s!\n", dictionary_file);
+            return 1;
+        }
+        options.dictionary = &dict;
+    }
+    size_t failed = batch_run((const char* const*)(argv + i), (size_t)(argc - i), (BatchMode)mode, jobs, force, &options);
+    if (dictionary_file) huffman_dictionary_free(&dict);
+    return failed == 0 ? 0 : 1;
+}
+
+// Trenowanie słownika dla krótkich wiadomości: huffman --train słownik [-l N] [-i id] próbki...
+static int run_train(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage();
+        return 1;
+    }
+    const char* output = argv[2];
+    int max_code_length = HUFFMAN_DEFAULT_MAX_CODE_LEN;
+    uint32_t id = 0;
+
+    int i = 3;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            max_code_length = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            id = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (i == argc) {
+        print_usage();
+        return 1;
+    }
+
+    uint64_t frequencies[MAX_CHARS] = {0}, total = 0;
+    for (; i < argc; i++) {
+        uint64_t counts[MAX_CHARS], file_total = 0;
+        huffman_count_frequencies(argv[i], counts);
+        for (int c = 0; c < MAX_CHARS; c++) {
+            frequencies[c] += counts[c];
+            file_total += counts[c];
+        }
+        if (file_total == 0) {
+            printf("Błąd: Nie udało się odczytać próbki %s!\n", argv[i]);
+            return 1;
+        }
+        total += file_total;
+    }
+
+    HuffmanDictionary dict;
+    if (!huffman_dictionary_train(&dict, id, frequencies, max_code_length)) {
+        printf("Błąd: Maksymalna długość kodu słownika musi być z zakresu 8-%d!\n", HUFFMAN_MAX_CODE_LEN);
+        return 1;
+    }
+    int ok = huffman_dictionary_save(&dict, output);
+    if (ok) {
+        uint64_t bits = 0;
+        for (int c = 0; c < MAX_CHARS; c++) bits += frequencies[c] * dict.codes[c].length;
+        printf("Słownik %s: id 0x%08x, próbki %llu B, średnio %.3f bit/bajt\n", output, dict.id,
+               (unsigned long long)total, (double)bits / (double)total);
+    } else {
+        printf("Błąd: Nie udało się zapisać słownika!\n");
+    }
+    huffman_dictionary_free(&dict);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--train") == 0) return run_train(argc, argv);
+    if (argc > 1) return run_batch(argc, argv);
+
     printf("=== PROGRAM KOMPRESJI I DEKOMPRESJI HUFFMANA ===\n");
 
     while (1) {
@@ -0,0 +1,119 @@
+#include "pq_baseline.h"
+#include <stdlib.h>
+#include <stdint.h>
+
+// Umieszcza węzeł na pozycji `index` i aktualizuje mapę pozycji
+static void place(PQBaseline* pq, size_t index, PQBaselineNode node) {
+    pq->heap[index] = node;
+    pq->positions[node.handle] = index;
+}
+
+static void heapify_up(PQBaseline* pq, size_t index) {
+    PQBaselineNode node = pq->heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (pq->heap[parent].priority <= node.priority) {
+            break;
+        }
+        place(pq, index, pq->heap[parent]);
+        index = parent;
+    }
+    place(pq, index, node);
+}
+
+static void heapify_down(PQBaseline* pq, size_t index) {
+    PQBaselineNode node = pq->heap[index];
+    while (1) {
+        size_t left = 2 * index + 1;
+        size_t right = 2 * index + 2;
+        size_t smallest = index;
+        int smallest_priority = node.priority;
+
+        if (left < pq->size && pq->heap[left].priority < smallest_priority) {
+            smallest = left;
+            smallest_priority = pq->heap[left].priority;
+        }
+        if (right < pq->size && pq->heap[right].priority < smallest_priority) {
+            smallest = right;
+        }
+
+        if (smallest == index) {
+            break;
+        }
+
+        place(pq, index, pq->heap[smallest]);
+        index = smallest;
+    }
+    place(pq, index, node);
+}
+
+static int reserve(PQBaseline* pq, size_t capacity) {
+    if (capacity <= pq->capacity) return 1;
+
+    PQBaselineNode* new_heap = (PQBaselineNode*)realloc(pq->heap, capacity * sizeof(PQBaselineNode));
+    if (!new_heap) return 0;
+    pq->heap = new_heap;
+
+    size_t* new_positions = (size_t*)realloc(pq->positions, (capacity + 1) * sizeof(size_t));
+    if (!new_positions) return 0;
+    pq->positions = new_positions;
+
+    size_t* new_free = (size_t*)realloc(pq->free_handles, capacity * sizeof(size_t));
+    if (!new_free) return 0;
+    pq->free_handles = new_free;
+
+    pq->capacity = capacity;
+    return 1;
+}
+
+PQBaseline* pq_baseline_create(size_t initial_capacity) {
+    PQBaseline* pq = (PQBaseline*)calloc(1, sizeof(PQBaseline));
+    if (!pq) return NULL;
+
+    if (!reserve(pq, initial_capacity > 0 ? initial_capacity : 16)) {
+        pq_baseline_destroy(pq);
+        return NULL;
+    }
+    return pq;
+}
+
+void pq_baseline_destroy(PQBaseline* pq) {
+    if (pq) {
+        free(pq->heap);
+        free(pq->positions);
+        free(pq->free_handles);
+        free(pq);
+    }
+}
+
+size_t pq_baseline_add(PQBaseline* pq, void* data, int priority) {
+    if (!pq) return 0;
+
+    if (pq->size >= pq->capacity && !reserve(pq, pq->capacity * 2)) {
+        return 0;
+    }
+
+    size_t handle = pq->free_count > 0 ? pq->free_handles[--pq->free_count] : ++pq->handle_count;
+    pq->heap[pq->size].data = data;
+    pq->heap[pq->size].priority = priority;
+    pq->heap[pq->size].handle = handle;
+    pq->size++;
+
+    heapify_up(pq, pq->size - 1);
+    return handle;
+}
+
+void* pq_baseline_remove(PQBaseline* pq) {
+    if (!pq || pq->size == 0) return NULL;
+
+    PQBaselineNode removed = pq->heap[0];
+    pq->positions[removed.handle] = SIZE_MAX;
+    pq->free_handles[pq->free_count++] = removed.handle;
+
+    pq->size--;
+    if (pq->size > 0) {
+        place(pq, 0, pq->heap[pq->size]);
+        heapify_down(pq, 0);
+    }
+    return removed.data;
+}
@@ -0,0 +1,29 @@
+#ifndef PQ_BASELINE_H
+#define PQ_BASELINE_H
+
+#include <stddef.h>
+
+// Kopiec binarny z tablicą struktur (dane, priorytet, uchwyt) i mapą pozycji uchwytów: układ
+// PriorityQueue sprzed przejścia na kopiec d-arny SoA. Tylko do porównań w pq_bench.
+typedef struct {
+    void* data;
+    int priority;
+    size_t handle;
+} PQBaselineNode;
+
+typedef struct {
+    PQBaselineNode* heap;
+    size_t size;
+    size_t capacity;
+    size_t* positions;        // Indeks w kopcu dla każdego uchwytu (SIZE_MAX = uchwyt wolny)
+    size_t* free_handles;     // Stos zwolnionych uchwytów
+    size_t free_count;
+    size_t handle_count;
+} PQBaseline;
+
+PQBaseline* pq_baseline_create(size_t initial_capacity);
+void pq_baseline_destroy(PQBaseline* pq);
+size_t pq_baseline_add(PQBaseline* pq, void* data, int priority);
+void* pq_baseline_remove(PQBaseline* pq);
+
+#endif // PQ_BASELINE_H
@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "priority_queue.h"
+#include "pq_baseline.h"
+
+#define PQ_BENCH_MIN 1000
+#define PQ_BENCH_MAX 10000000
+#define PQ_BENCH_OPS 10000000   // Łączna liczba wstawień dla jednego rozmiaru
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// To samo dla kopca binarnego AoS sprzed przejścia na SoA (punkt odniesienia)
+static int run_baseline_round(const int* keys, size_t n, double* push_time, double* pop_time) {
+    PQBaseline* pq = pq_baseline_create(n);
+    if (!pq) return 0;
+
+    double t0 = now_seconds();
+    for (size_t i = 0; i < n; i++) {
+        pq_baseline_add(pq, (void*)(keys + i), keys[i]);
+    }
+    double t1 = now_seconds();
+
+    int ok = 1, previous = -1;
+    for (size_t i = 0; i < n; i++) {
+        const int* top = (const int*)pq_baseline_remove(pq);
+        if (!top || *top < previous) ok = 0;
+        if (top) previous = *top;
+    }
+    double t2 = now_seconds();
+
+    *push_time += t1 - t0;
+    *pop_time += t2 - t1;
+    pq_baseline_destroy(pq);
+    return ok;
+}
+
+// Wstawia n losowych kluczy i zdejmuje wszystkie; zwraca 0, gdy kolejność zdejmowania jest błędna
+static int run_round(size_t arity, const int* keys, size_t n, double* push_time, double* pop_time) {
+    PriorityQueue* pq = pq_create_with_arity(n, arity);
+    if (!pq) return 0;
+
+    double t0 = now_seconds();
+    for (size_t i = 0; i < n; i++) {
+        pq_add(pq, (void*)(keys + i), keys[i]);
+    }
+    double t1 = now_seconds();
+
+    int ok = 1, previous = -1;
+    for (size_t i = 0; i < n; i++) {
+        const int* top = (const int*)pq_remove(pq);
+        if (!top || *top < previous) ok = 0;
+        if (top) previous = *top;
+    }
+    double t2 = now_seconds();
+
+    *push_time += t1 - t0;
+    *pop_time += t2 - t1;
+    pq_destroy(pq);
+    return ok;
+}
+
+// To samo przez pq_add_batch i pq_pop_n
+static int run_batch_round(const int* keys, size_t n, void** items, double* push_time, double* pop_time) {
+    PriorityQueue* pq = pq_create(n);
+    if (!pq) return 0;
+
+    for (size_t i = 0; i < n; i++) {
+        items[i] = (void*)(keys + i);
+    }
+
+    double t0 = now_seconds();
+    int ok = pq_add_batch(pq, items, keys, n, NULL);
+    double t1 = now_seconds();
+    ok = ok && pq_pop_n(pq, items, NULL, n) == n;
+    double t2 = now_seconds();
+
+    for (size_t i = 1; ok && i < n; i++) {
+        if (*(const int*)items[i] < *(const int*)items[i - 1]) ok = 0;
+    }
+
+    *push_time += t1 - t0;
+    *pop_time += t2 - t1;
+    pq_destroy(pq);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_size = PQ_BENCH_MAX;
+    if (argc > 1) {
+        max_size = (size_t)strtoull(argv[1], NULL, 10);
+        if (max_size < PQ_BENCH_MIN) max_size = PQ_BENCH_MIN;
+    }
+
+    int* keys = (int*)malloc(max_size * sizeof(int));
+    void** items = (void**)malloc(max_size * sizeof(void*));
+    if (!keys || !items) {
+        printf("Błąd: Brak pamięci!\n");
+        free(keys);
+        free(items);
+        return 1;
+    }
+    for (size_t i = 0; i < max_size; i++) {
+        keys[i] = (int)(rng_next() % 1000000000u);
+    }
+
+    static const size_t arities[] = {2, 4, 8};
+    printf("%10s %6s %16s %16s\n", "elementy", "d", "wstawianie Mop/s", "usuwanie Mop/s");
+    for (size_t n = PQ_BENCH_MIN; n <= max_size; n *= 10) {
+        size_t rounds = PQ_BENCH_OPS / n > 0 ? PQ_BENCH_OPS / n : 1;
+        double base_push = 0, base_pop = 0;
+        int base_ok = 1;
+        for (size_t r = 0; r < rounds; r++) {
+            base_ok = run_baseline_round(keys, n, &base_push, &base_pop) && base_ok;
+        }
+        double base_ops = (double)(n * rounds) / 1e6;
+        printf("%10zu %6s %16.2f %16.2f  %s\n", n, "AoS 2", base_ops / base_push, base_ops / base_pop,
+               base_ok ? "OK" : "BŁĄD");
+
+        for (size_t a = 0; a < sizeof(arities) / sizeof(arities[0]); a++) {
+            double push_time = 0, pop_time = 0;
+            int ok = 1;
+            for (size_t r = 0; r < rounds; r++) {
+                ok = run_round(arities[a], keys, n, &push_time, &pop_time) && ok;
+            }
+            double ops = (double)(n * rounds) / 1e6;
+            printf("%10zu %6zu %16.2f %16.2f  %s\n", n, arities[a], ops / push_time, ops / pop_time, ok ? "OK" : "BŁĄD");
+        }
+
+        double push_time = 0, pop_time = 0;
+        int ok = 1;
+        for (size_t r = 0; r < rounds; r++) {
+            ok = run_batch_round(keys, n, items, &push_time, &pop_time) && ok;
+        }
+        double ops = (double)(n * rounds) / 1e6;
+        printf("%10zu %6s %16.2f %16.2f  %s\n", n, "partia", ops / push_time, ops / pop_time, ok ? "OK" : "BŁĄD");
+    }
+
+    free(keys);
+    free(items);
+    return 0;
+}
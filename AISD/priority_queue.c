@@ -2,53 +2,157 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+
+#define PQ_CACHE_LINE 64
+
+// Umieszcza element na pozycji `index` i aktualizuje mapę pozycji
+static void place(PriorityQueue* pq, size_t index, int priority, void* data, PQHandle handle) {
+    pq->priorities[index] = priority;
+    pq->data[index] = data;
+    pq->handles[index] = handle;
+    pq->positions[handle] = index;
+}
+
+static void move(PriorityQueue* pq, size_t to, size_t from) {
+    place(pq, to, pq->priorities[from], pq->data[from], pq->handles[from]);
+}
+
+// Głębokość węzła w kopcu; liczona tylko dla statystyk, aby pętle przesiewania nie miały licznika
+static uint64_t node_depth(const PriorityQueue* pq, size_t index) {
+    uint64_t depth = 0;
+    while (index > 0) {
+        index = (index - 1) >> pq->arity_shift;
+        depth++;
+    }
+    return depth;
+}
 
 static void heapify_up(PriorityQueue* pq, size_t index) {
+    int priority = pq->priorities[index];
+    void* data = pq->data[index];
+    PQHandle handle = pq->handles[index];
+    size_t start = index;
+
     while (index > 0) {
-        size_t parent = (index - 1) / 2;
-        if (pq->heap[parent].priority <= pq->heap[index].priority) {
+        size_t parent = (index - 1) >> pq->arity_shift;
+        if (pq->priorities[parent] <= priority) {
             break;
         }
-        PQNode temp = pq->heap[parent];
-        pq->heap[parent] = pq->heap[index];
-        pq->heap[index] = temp;
+        move(pq, index, parent);
         index = parent;
     }
+    place(pq, index, priority, data, handle);
+
+    if (pq->stats_enabled) {
+        uint64_t levels = node_depth(pq, start) - node_depth(pq, index);
+        pq->stats.sift_up_levels += levels;
+        if (levels > pq->stats.sift_up_max) pq->stats.sift_up_max = levels;
+    }
 }
 
 static void heapify_down(PriorityQueue* pq, size_t index) {
-    while (1) {
-        size_t left = 2 * index + 1;
-        size_t right = 2 * index + 2;
-        size_t smallest = index;
+    int priority = pq->priorities[index];
+    void* data = pq->data[index];
+    PQHandle handle = pq->handles[index];
+    const int* keys = pq->priorities;
+    size_t start = index;
 
-        if (left < pq->size && pq->heap[left].priority < pq->heap[smallest].priority) {
-            smallest = left;
+    while (1) {
+        size_t first = (index << pq->arity_shift) + 1;
+        if (first >= pq->size) {
+            break;
         }
-        if (right < pq->size && pq->heap[right].priority < pq->heap[smallest].priority) {
-            smallest = right;
+        size_t last = first + pq->arity < pq->size ? first + pq->arity : pq->size;
+
+        // Wszystkie dzieci leżą w jednej linii pamięci podręcznej
+        size_t smallest = first;
+        int smallest_priority = keys[first];
+        for (size_t child = first + 1; child < last; child++) {
+            if (keys[child] < smallest_priority) {
+                smallest = child;
+                smallest_priority = keys[child];
+            }
         }
 
-        if (smallest == index) {
+        if (smallest_priority >= priority) {
             break;
         }
 
-        PQNode temp = pq->heap[index];
-        pq->heap[index] = pq->heap[smallest];
-        pq->heap[smallest] = temp;
+        move(pq, index, smallest);
         index = smallest;
     }
+    place(pq, index, priority, data, handle);
+
+    if (pq->stats_enabled) {
+        uint64_t levels = node_depth(pq, index) - node_depth(pq, start);
+        pq->stats.sift_down_levels += levels;
+        if (levels > pq->stats.sift_down_max) pq->stats.sift_down_max = levels;
+    }
+}
+
+// Powiększa tablice tak, aby zmieściło się `capacity` elementów
+static int reserve(PriorityQueue* pq, size_t capacity) {
+    if (capacity <= pq->capacity) return 1;
+
+    // Element 0 leży na pozycji arity - 1 wyrównanej alokacji, więc grupa dzieci
+    // węzła i (elementy arity*i+1 .. arity*i+arity) zaczyna się na pozycji arity*(i+1)
+    size_t pad = pq->arity - 1;
+    size_t bytes = (capacity + pad) * sizeof(int);
+    bytes = (bytes + PQ_CACHE_LINE - 1) / PQ_CACHE_LINE * PQ_CACHE_LINE;
+    int* base = (int*)aligned_alloc(PQ_CACHE_LINE, bytes);
+    if (!base) return 0;
+    if (pq->size > 0) memcpy(base + pad, pq->priorities, pq->size * sizeof(int));
+    free(pq->priorities_base);
+    pq->priorities_base = base;
+    pq->priorities = base + pad;
+
+    void** new_data = (void**)realloc(pq->data, capacity * sizeof(void*));
+    if (!new_data) return 0;
+    pq->data = new_data;
+
+    PQHandle* new_handles = (PQHandle*)realloc(pq->handles, capacity * sizeof(PQHandle));
+    if (!new_handles) return 0;
+    pq->handles = new_handles;
+
+    size_t* new_positions = (size_t*)realloc(pq->positions, (capacity + 1) * sizeof(size_t));
+    if (!new_positions) return 0;
+    pq->positions = new_positions;
+
+    PQHandle* new_free = (PQHandle*)realloc(pq->free_handles, capacity * sizeof(PQHandle));
+    if (!new_free) return 0;
+    pq->free_handles = new_free;
+
+    pq->capacity = capacity;
+    return 1;
+}
+
+static PQHandle acquire_handle(PriorityQueue* pq) {
+    if (pq->free_count > 0) {
+        return pq->free_handles[--pq->free_count];
+    }
+    return ++pq->handle_count;
+}
+
+static void release_handle(PriorityQueue* pq, PQHandle handle) {
+    pq->positions[handle] = SIZE_MAX;
+    pq->free_handles[pq->free_count++] = handle;
 }
 
 PriorityQueue* pq_create(size_t initial_capacity) {
-    PriorityQueue* pq = (PriorityQueue*)malloc(sizeof(PriorityQueue));
+    return pq_create_with_arity(initial_capacity, PQ_DEFAULT_ARITY);
+}
+
+PriorityQueue* pq_create_with_arity(size_t initial_capacity, size_t arity) {
+    if (arity < 2 || arity > PQ_MAX_ARITY || (arity & (arity - 1)) != 0) return NULL;
+
+    PriorityQueue* pq = (PriorityQueue*)calloc(1, sizeof(PriorityQueue));
     if (!pq) return NULL;
+    pq->arity = arity;
+    while (((size_t)1 << pq->arity_shift) < arity) pq->arity_shift++;
 
-    pq->capacity = initial_capacity > 0 ? initial_capacity : 16;
-    pq->size = 0;
-    pq->heap = (PQNode*)malloc(pq->capacity * sizeof(PQNode));
-    if (!pq->heap) {
-        free(pq);
+    if (!reserve(pq, initial_capacity > 0 ? initial_capacity : 16)) {
+        pq_destroy(pq);
         return NULL;
     }
 
@@ -57,74 +161,84 @@ PriorityQueue* pq_create(size_t initial_capacity) {
 
 void pq_destroy(PriorityQueue* pq) {
     if (pq) {
-        free(pq->heap);
+        free(pq->priorities_base);
+        free(pq->data);
+        free(pq->handles);
+        free(pq->positions);
+        free(pq->free_handles);
         free(pq);
     }
 }
 
-int pq_add(PriorityQueue* pq, void* data, int priority) {
-    if (!pq) return 0;
+PQHandle pq_add(PriorityQueue* pq, void* data, int priority) {
+    if (!pq) return PQ_INVALID_HANDLE;
 
-    if (pq->size >= pq->capacity) {
-        size_t new_capacity = pq->capacity * 2;
-        PQNode* new_heap = (PQNode*)realloc(pq->heap, new_capacity * sizeof(PQNode));
-        if (!new_heap) return 0;
-        pq->heap = new_heap;
-        pq->capacity = new_capacity;
+    if (pq->size >= pq->capacity && !reserve(pq, pq->capacity * 2)) {
+        return PQ_INVALID_HANDLE;
     }
 
-    pq->heap[pq->size].data = data;
-    pq->heap[pq->size].priority = priority;
+    PQHandle handle = acquire_handle(pq);
+    place(pq, pq->size, priority, data, handle);
     pq->size++;
+    if (pq->stats_enabled) pq->stats.pushes++;
 
     heapify_up(pq, pq->size - 1);
-    return 1;
+    return handle;
 }
 
-void* pq_remove(PriorityQueue* pq) {
-    if (!pq || pq->size == 0) return NULL;
+// Usuwa element z pozycji `index`, wstawiając na jego miejsce ostatni element kopca
+static void* remove_at(PriorityQueue* pq, size_t index) {
+    void* removed = pq->data[index];
+    release_handle(pq, pq->handles[index]);
+    if (pq->stats_enabled) pq->stats.pops++;
 
-    void* result = pq->heap[0].data;
-    pq->heap[0] = pq->heap[pq->size - 1];
     pq->size--;
-    if (pq->size > 0) {
-        heapify_down(pq, 0);
+    if (index < pq->size) {
+        move(pq, index, pq->size);
+        if (index > 0 && pq->priorities[index] < pq->priorities[(index - 1) >> pq->arity_shift]) {
+            heapify_up(pq, index);
+        } else {
+            heapify_down(pq, index);
+        }
     }
 
-    return result;
+    return removed;
 }
-static size_t find_index(PriorityQueue* pq, void* data) {
-    for (size_t i = 0; i < pq->size; i++) {
-        if (pq->heap[i].data == data) {
-            return i;
-        }
-    }
-    return SIZE_MAX;
+
+void* pq_remove(PriorityQueue* pq) {
+    if (!pq || pq->size == 0) return NULL;
+    return remove_at(pq, 0);
 }
 
-int pq_decrease_priority(PriorityQueue* pq, void* data, int new_priority) {
-    if (!pq) return 0;
+int pq_contains(PriorityQueue* pq, PQHandle handle) {
+    return pq && handle != PQ_INVALID_HANDLE && handle <= pq->handle_count &&
+           pq->positions[handle] != SIZE_MAX;
+}
 
-    size_t index = find_index(pq, data);
-    if (index == SIZE_MAX) return 0;
+void* pq_remove_handle(PriorityQueue* pq, PQHandle handle) {
+    if (!pq_contains(pq, handle)) return NULL;
+    return remove_at(pq, pq->positions[handle]);
+}
+
+int pq_decrease_priority(PriorityQueue* pq, PQHandle handle, int new_priority) {
+    if (!pq_contains(pq, handle)) return 0;
 
-    if (new_priority >= pq->heap[index].priority) {
+    size_t index = pq->positions[handle];
+    if (new_priority >= pq->priorities[index]) {
         return 0;
     }
 
-    pq->heap[index].priority = new_priority;
+    pq->priorities[index] = new_priority;
     heapify_up(pq, index);
     return 1;
 }
 
-int pq_set_priority(PriorityQueue* pq, void* data, int new_priority) {
-    if (!pq) return 0;
-
-    size_t index = find_index(pq, data);
-    if (index == SIZE_MAX) return 0;
+int pq_set_priority(PriorityQueue* pq, PQHandle handle, int new_priority) {
+    if (!pq_contains(pq, handle)) return 0;
 
-    int old_priority = pq->heap[index].priority;
-    pq->heap[index].priority = new_priority;
+    size_t index = pq->positions[handle];
+    int old_priority = pq->priorities[index];
+    pq->priorities[index] = new_priority;
 
     if (new_priority < old_priority) {
         heapify_up(pq, index);
@@ -134,22 +248,82 @@ int pq_set_priority(PriorityQueue* pq, void* data, int new_priority) {
     return 1;
 }
 
-PriorityQueue* pq_build(void* data_array[], int priorities[], size_t count) {
-    if (!data_array || !priorities || count == 0) return NULL;
+// Przywraca własność kopca dla całej tablicy w czasie O(n)
+static void heapify_all(PriorityQueue* pq) {
+    for (size_t i = pq->size > 1 ? ((pq->size - 2) >> pq->arity_shift) + 1 : 0; i-- > 0;) {
+        heapify_down(pq, i);
+    }
+}
 
-    PriorityQueue* pq = pq_create(count);
-    if (!pq) return NULL;
+// Dopisuje elementy na koniec kopca. Gdy nowych elementów jest co najmniej tyle, co starych,
+// kopiec budowany jest od nowa w O(n + k), w przeciwnym razie każdy element jest przesiewany w górę.
+// Uchwyty nowych elementów trafiają do `handles` (może być NULL).
+int pq_add_batch(PriorityQueue* pq, void* data_array[], const int priorities[], size_t count, PQHandle handles[]) {
+    if (!pq || (count > 0 && (!data_array || !priorities))) return 0;
+
+    size_t old_size = pq->size;
+    if (old_size + count > pq->capacity) {
+        size_t capacity = pq->capacity * 2 > old_size + count ? pq->capacity * 2 : old_size + count;
+        if (!reserve(pq, capacity)) return 0;
+    }
 
     for (size_t i = 0; i < count; i++) {
-        pq->heap[i].data = data_array[i];
-        pq->heap[i].priority = priorities[i];
-        pq->size++;
+        PQHandle handle = acquire_handle(pq);
+        place(pq, old_size + i, priorities[i], data_array[i], handle);
+        if (handles) handles[i] = handle;
     }
+    pq->size += count;
+    if (pq->stats_enabled) pq->stats.pushes += count;
+
+    if (count >= old_size) {
+        heapify_all(pq);
+    } else {
+        for (size_t i = old_size; i < pq->size; i++) {
+            heapify_up(pq, i);
+        }
+    }
+    return 1;
+}
+
+// Zdejmuje do `k` elementów o najniższych priorytetach (rosnąco); zwraca liczbę zdjętych.
+// `out_priorities` może być NULL.
+size_t pq_pop_n(PriorityQueue* pq, void* out_data[], int out_priorities[], size_t k) {
+    if (!pq || !out_data) return 0;
+
+    size_t n = k < pq->size ? k : pq->size;
+    for (size_t i = 0; i < n; i++) {
+        if (out_priorities) out_priorities[i] = pq->priorities[0];
+        out_data[i] = remove_at(pq, 0);
+    }
+    return n;
+}
 
-    for (int i = (int)count / 2 - 1; i >= 0; i--) {
-        heapify_down(pq, (size_t)i);
+// Przenosi wszystkie elementy `src` do `dst` (w O(n + m), gdy src nie jest mniejsza od dst).
+// Elementy dostają nowe uchwyty w `dst`; `src` zostaje pusta, a jej dawne uchwyty tracą ważność.
+int pq_meld(PriorityQueue* dst, PriorityQueue* src) {
+    if (!dst || !src || dst == src) return 0;
+    if (!pq_add_batch(dst, src->data, src->priorities, src->size, NULL)) return 0;
+
+    for (size_t h = 1; h <= src->handle_count; h++) {
+        src->positions[h] = SIZE_MAX;
     }
+    src->size = 0;
+    src->free_count = 0;
+    src->handle_count = 0;
+    return 1;
+}
+
+// Elementy dostają uchwyty 1..count w kolejności tablicy wejściowej; count == 0 daje pustą kolejkę
+PriorityQueue* pq_build(void* data_array[], int priorities[], size_t count) {
+    if (count > 0 && (!data_array || !priorities)) return NULL;
 
+    PriorityQueue* pq = pq_create(count);
+    if (!pq) return NULL;
+
+    if (!pq_add_batch(pq, data_array, priorities, count, NULL)) {
+        pq_destroy(pq);
+        return NULL;
+    }
     return pq;
 }
 int pq_is_empty(PriorityQueue* pq) {
@@ -168,13 +342,41 @@ void pq_print(PriorityQueue* pq, void (*print_func)(void*)) {
 
     printf("Kolejka priorytetowa (rozmiar: %zu):\n", pq->size);
     for (size_t i = 0; i < pq->size; i++) {
-        printf("  [%zu] Priorytet: %d, Dane: ", i, pq->heap[i].priority);
+        printf("  [%zu] Priorytet: %d, Uchwyt: %zu, Dane: ", i, pq->priorities[i], pq->handles[i]);
         if (print_func) {
-            print_func(pq->heap[i].data);
+            print_func(pq->data[i]);
         } else {
-            printf("%p", pq->heap[i].data);
+            printf("%p", pq->data[i]);
         }
         printf("\n");
     }
 }
 
+void pq_enable_stats(PriorityQueue* pq, int enable) {
+    if (pq) pq->stats_enabled = enable != 0;
+}
+
+void pq_get_stats(const PriorityQueue* pq, PQStats* stats) {
+    if (pq) {
+        *stats = pq->stats;
+    } else {
+        memset(stats, 0, sizeof(PQStats));
+    }
+}
+
+void pq_reset_stats(PriorityQueue* pq) {
+    if (pq) memset(&pq->stats, 0, sizeof(PQStats));
+}
+
+void pq_print_stats(const PQStats* stats) {
+    printf("Kolejka: wstawienia %llu, usunięcia %llu\n",
+           (unsigned long long)stats->pushes, (unsigned long long)stats->pops);
+    printf("Przesiewanie w górę: %llu poziomów (średnio %.2f, najwięcej %llu)\n",
+           (unsigned long long)stats->sift_up_levels,
+           stats->pushes ? (double)stats->sift_up_levels / (double)stats->pushes : 0.0,
+           (unsigned long long)stats->sift_up_max);
+    printf("Przesiewanie w dół: %llu poziomów (średnio %.2f, najwięcej %llu)\n",
+           (unsigned long long)stats->sift_down_levels,
+           stats->pops ? (double)stats->sift_down_levels / (double)stats->pops : 0.0,
+           (unsigned long long)stats->sift_down_max);
+}
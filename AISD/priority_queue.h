@@ -2,31 +2,65 @@
 #define PRIORITY_QUEUE_H
 
 #include <stddef.h>
+#include <stdint.h>
 
-// Struktura węzła kolejki priorytetowej
-typedef struct PQNode {
-    void* data;           // Wskaźnik na dane
-    int priority;         // Priorytet (mniejsza wartość = wyższy priorytet)
-} PQNode;
+// Uchwyt elementu kolejki: stały od pq_add do usunięcia elementu (0 = brak elementu)
+typedef size_t PQHandle;
 
-// Struktura kolejki priorytetowej (min-heap)
+#define PQ_INVALID_HANDLE 0
+#define PQ_DEFAULT_ARITY 4
+#define PQ_MAX_ARITY 16
+
+// Liczniki operacji kolejki: domyślnie wyłączone (pq_enable_stats), zerowane przez pq_reset_stats
+typedef struct {
+    uint64_t pushes;          // Wstawione elementy (także przez pq_add_batch)
+    uint64_t pops;            // Usunięte elementy
+    uint64_t sift_up_levels;  // Poziomy pokonane przy przesiewaniu w górę
+    uint64_t sift_down_levels;
+    uint64_t sift_up_max;     // Najgłębsze pojedyncze przesiewanie w górę
+    uint64_t sift_down_max;
+} PQStats;
+
+// Struktura kolejki priorytetowej (d-arny min-heap).
+// Priorytety, dane i uchwyty leżą w osobnych tablicach, więc porównania czytają tylko
+// ciągłą tablicę priorytetów; dzieci węzła zaczynają się na granicy grupy `arity` kluczy.
 typedef struct PriorityQueue {
-    PQNode* heap;         // Tablica węzłów
+    int* priorities;      // Priorytety (mniejsza wartość = wyższy priorytet)
+    void** data;          // Wskaźniki na dane
+    PQHandle* handles;    // Uchwyty elementów
     size_t size;          // Aktualna liczba elementów
-    size_t capacity;      // Pojemność tablicy
+    size_t capacity;      // Pojemność tablic
+    size_t arity;         // Liczba dzieci węzła (potęga dwójki)
+    unsigned arity_shift; // log2(arity): rodzic i dzieci liczone przesunięciami
+    int* priorities_base; // Początek wyrównanej alokacji tablicy priorytetów
+    size_t* positions;    // Indeks w kopcu dla każdego uchwytu (SIZE_MAX = uchwyt wolny)
+    PQHandle* free_handles;   // Stos zwolnionych uchwytów
+    size_t free_count;
+    size_t handle_count;  // Liczba wydanych dotąd uchwytów
+    int stats_enabled;    // Liczniki aktualizowane tylko po pq_enable_stats
+    PQStats stats;
 } PriorityQueue;
 
 // Funkcje kolejki priorytetowej
 PriorityQueue* pq_create(size_t initial_capacity);
+PriorityQueue* pq_create_with_arity(size_t initial_capacity, size_t arity);
 void pq_destroy(PriorityQueue* pq);
-int pq_add(PriorityQueue* pq, void* data, int priority);
+PQHandle pq_add(PriorityQueue* pq, void* data, int priority);
 void* pq_remove(PriorityQueue* pq);
-int pq_decrease_priority(PriorityQueue* pq, void* data, int new_priority);
-int pq_set_priority(PriorityQueue* pq, void* data, int new_priority);
+void* pq_remove_handle(PriorityQueue* pq, PQHandle handle);
+int pq_contains(PriorityQueue* pq, PQHandle handle);
+int pq_decrease_priority(PriorityQueue* pq, PQHandle handle, int new_priority);
+int pq_set_priority(PriorityQueue* pq, PQHandle handle, int new_priority);
 PriorityQueue* pq_build(void* data_array[], int priorities[], size_t count);
+int pq_add_batch(PriorityQueue* pq, void* data_array[], const int priorities[], size_t count, PQHandle handles[]);
+size_t pq_pop_n(PriorityQueue* pq, void* out_data[], int out_priorities[], size_t k);
+int pq_meld(PriorityQueue* dst, PriorityQueue* src);
 int pq_is_empty(PriorityQueue* pq);
 size_t pq_size(PriorityQueue* pq);
 void pq_print(PriorityQueue* pq, void (*print_func)(void*));
+void pq_enable_stats(PriorityQueue* pq, int enable);
+void pq_get_stats(const PriorityQueue* pq, PQStats* stats);
+void pq_reset_stats(PriorityQueue* pq);
+void pq_print_stats(const PQStats* stats);
 
 #endif // PRIORITY_QUEUE_H
-
@@ -0,0 +1,135 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "threadpool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct ThreadPool {
+    pthread_t* workers;
+    int worker_count;             // Wątki pomocnicze (bez wątku wywołującego)
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    ThreadPoolTask task;
+    void* context;
+    size_t count;
+    size_t next;                  // Następny indeks do pobrania
+    size_t finished;              // Liczba zakończonych indeksów
+    unsigned long generation;     // Numer bieżącej pętli (budzi pracowników)
+    int active;                   // Pracownicy wciąż zajęci bieżącą pętlą
+    int stop;
+};
+
+// Pobiera i wykonuje indeksy bieżącej pętli; wywoływana z zablokowanym mutexem
+static void run_tasks(ThreadPool* pool) {
+    while (pool->next < pool->count) {
+        size_t index = pool->next++;
+        pthread_mutex_unlock(&pool->mutex);
+        pool->task(pool->context, index);
+        pthread_mutex_lock(&pool->mutex);
+        pool->finished++;
+    }
+}
+
+static void* worker_main(void* arg) {
+    ThreadPool* pool = (ThreadPool*)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->mutex);
+        }
+        if (pool->stop) break;
+
+        seen = pool->generation;
+        pool->active++;
+        run_tasks(pool);
+        pool->active--;
+        if (pool->finished == pool->count && pool->active == 0) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+int threadpool_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+ThreadPool* threadpool_create(int threads) {
+    if (threads <= 0) threads = threadpool_cpu_count();
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    if (threads > 1) {
+        pool->workers = (pthread_t*)malloc((size_t)(threads - 1) * sizeof(pthread_t));
+        if (!pool->workers) {
+            threadpool_destroy(pool);
+            return NULL;
+        }
+        for (int i = 0; i < threads - 1; i++) {
+            if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) break;
+            pool->worker_count++;
+        }
+    }
+
+    return pool;
+}
+
+void threadpool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    free(pool);
+}
+
+void threadpool_for(ThreadPool* pool, size_t count, ThreadPoolTask task, void* context) {
+    if (count == 0) return;
+
+    if (!pool || pool->worker_count == 0 || count == 1) {
+        for (size_t i = 0; i < count; i++) task(context, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    pool->next = 0;
+    pool->finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    run_tasks(pool);
+    while (pool->finished < pool->count || pool->active > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int threadpool_size(const ThreadPool* pool) {
+    return pool ? pool->worker_count + 1 : 1;
+}
@@ -0,0 +1,19 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stddef.h>
+
+// Zadanie wykonywane dla kolejnych indeksów 0..count-1
+typedef void (*ThreadPoolTask)(void* context, size_t index);
+
+// Pula wątków wykonująca równoległe pętle. Wątek wywołujący też bierze udział w pracy.
+typedef struct ThreadPool ThreadPool;
+
+// Funkcje puli wątków
+ThreadPool* threadpool_create(int threads);
+void threadpool_destroy(ThreadPool* pool);
+void threadpool_for(ThreadPool* pool, size_t count, ThreadPoolTask task, void* context);
+int threadpool_size(const ThreadPool* pool);
+int threadpool_cpu_count(void);
+
+#endif // THREADPOOL_H
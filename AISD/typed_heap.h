@@ -0,0 +1,107 @@
+#ifndef TYPED_HEAP_H
+#define TYPED_HEAP_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+// Kopiec typowany generowany w czasie kompilacji: TYPED_HEAP_DEFINE(nazwa, typ_klucza, typ_wartości, less)
+// tworzy strukturę `nazwa` i funkcje static inline nazwa_init/free/push/pop/... bez void* i rzutowań.
+// `less(a, b)` porównuje klucze (np. TYPED_HEAP_LESS dla min-kopca). Bufor przekazany do
+// nazwa_init_fixed nie jest powiększany ani zwalniany (kopiec bez alokacji).
+#define TYPED_HEAP_LESS(a, b) ((a) < (b))
+
+#define TYPED_HEAP_DEFINE(name, key_type, value_type, less)                                   \
+    typedef struct {                                                                          \
+        key_type key;                                                                         \
+        value_type value;                                                                     \
+    } name##_item;                                                                            \
+                                                                                              \
+    typedef struct {                                                                          \
+        name##_item* items;                                                                   \
+        size_t size;                                                                          \
+        size_t capacity;                                                                      \
+        int owns_items;                                                                       \
+    } name;                                                                                   \
+                                                                                              \
+    static inline int name##_init(name* heap, size_t capacity) {                              \
+        heap->capacity = capacity > 0 ? capacity : 16;                                        \
+        heap->size = 0;                                                                       \
+        heap->owns_items = 1;                                                                 \
+        heap->items = (name##_item*)malloc(heap->capacity * sizeof(name##_item));             \
+        return heap->items != NULL;                                                           \
+    }                                                                                         \
+                                                                                              \
+    static inline void name##_init_fixed(name* heap, name##_item* buffer, size_t capacity) {  \
+        heap->items = buffer;                                                                 \
+        heap->capacity = capacity;                                                            \
+        heap->size = 0;                                                                       \
+        heap->owns_items = 0;                                                                 \
+    }                                                                                         \
+                                                                                              \
+    static inline void name##_free(name* heap) {                                              \
+        if (heap->owns_items) free(heap->items);                                              \
+        heap->items = NULL;                                                                   \
+        heap->size = heap->capacity = 0;                                                      \
+    }                                                                                         \
+                                                                                              \
+    static inline size_t name##_size(const name* heap) {                                      \
+        return heap->size;                                                                    \
+    }                                                                                         \
+                                                                                              \
+    static inline void name##_sift_up(name* heap, size_t index) {                             \
+        name##_item item = heap->items[index];                                                \
+        while (index > 0) {                                                                   \
+            size_t parent = (index - 1) / 2;                                                  \
+            if (!less(item.key, heap->items[parent].key)) break;                              \
+            heap->items[index] = heap->items[parent];                                         \
+            index = parent;                                                                   \
+        }                                                                                     \
+        heap->items[index] = item;                                                            \
+    }                                                                                         \
+                                                                                              \
+    static inline void name##_sift_down(name* heap, size_t index) {                           \
+        name##_item item = heap->items[index];                                                \
+        size_t size = heap->size;                                                             \
+        while (1) {                                                                           \
+            size_t child = 2 * index + 1;                                                     \
+            if (child >= size) break;                                                         \
+            if (child + 1 < size && less(heap->items[child + 1].key, heap->items[child].key)) \
+                child++;                                                                      \
+            if (!less(heap->items[child].key, item.key)) break;                               \
+            heap->items[index] = heap->items[child];                                          \
+            index = child;                                                                    \
+        }                                                                                     \
+        heap->items[index] = item;                                                            \
+    }                                                                                         \
+                                                                                              \
+    static inline int name##_push(name* heap, key_type key, value_type value) {               \
+        if (heap->size >= heap->capacity) {                                                   \
+            if (!heap->owns_items) return 0;                                                  \
+            size_t capacity = heap->capacity * 2;                                             \
+            name##_item* items = (name##_item*)realloc(heap->items,                           \
+                                                       capacity * sizeof(name##_item));       \
+            if (!items) return 0;                                                             \
+            heap->items = items;                                                              \
+            heap->capacity = capacity;                                                        \
+        }                                                                                     \
+        heap->items[heap->size].key = key;                                                    \
+        heap->items[heap->size].value = value;                                                \
+        name##_sift_up(heap, heap->size++);                                                   \
+        return 1;                                                                             \
+    }                                                                                         \
+                                                                                              \
+    static inline int name##_pop(name* heap, key_type* key, value_type* value) {              \
+        if (heap->size == 0) return 0;                                                        \
+        if (key) *key = heap->items[0].key;                                                   \
+        if (value) *value = heap->items[0].value;                                             \
+        heap->items[0] = heap->items[--heap->size];                                           \
+        if (heap->size > 0) name##_sift_down(heap, 0);                                        \
+        return 1;                                                                             \
+    }                                                                                         \
+                                                                                              \
+    /* Zamienia dowolne elementy items[0..size) w kopiec w czasie O(n) */                     \
+    static inline void name##_heapify(name* heap) {                                           \
+        for (size_t i = heap->size / 2; i-- > 0;) name##_sift_down(heap, i);                  \
+    }
+
+#endif // TYPED_HEAP_H